@@ -0,0 +1,13 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltActivationChange
+{
+    [NativeTypeName("unsigned int")]
+    public uint bodyId;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong userData;
+
+    [NativeTypeName("bool")]
+    public byte isActive;
+}
@@ -0,0 +1,23 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltBodyCreationOptions
+{
+    public EgJolt_MotionQuality motionQuality;
+
+    [NativeTypeName("bool")]
+    public byte enhancedInternalEdgeRemoval;
+
+    public EgJolt_AllowedDOFs allowedDOFs;
+
+    public float friction;
+
+    public float restitution;
+
+    public float linearDamping;
+
+    public float angularDamping;
+
+    public float maxLinearVelocity;
+
+    public float maxAngularVelocity;
+}
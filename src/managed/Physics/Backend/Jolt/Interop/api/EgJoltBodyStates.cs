@@ -0,0 +1,21 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public unsafe partial struct EgJoltBodyStates
+{
+    [NativeTypeName("EgJoltVector3 *")]
+    public System.Numerics.Vector3* positions;
+
+    [NativeTypeName("EgJoltQuaternion *")]
+    public System.Numerics.Quaternion* rotations;
+
+    [NativeTypeName("EgJoltVector3 *")]
+    public System.Numerics.Vector3* linearVelocities;
+
+    [NativeTypeName("EgJoltVector3 *")]
+    public System.Numerics.Vector3* angularVelocities;
+
+    public EgJolt_BodyFlags* flags;
+
+    [NativeTypeName("unsigned char *")]
+    public byte* layers;
+}
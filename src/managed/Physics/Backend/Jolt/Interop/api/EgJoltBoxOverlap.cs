@@ -0,0 +1,18 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltBoxOverlap
+{
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 center;
+
+    [NativeTypeName("EgJoltQuaternion")]
+    public System.Numerics.Quaternion rotation;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 halfExtents;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong layerMask;
+
+    public EgJolt_QueryFlags flags;
+}
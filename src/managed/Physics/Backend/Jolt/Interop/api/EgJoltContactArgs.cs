@@ -1,3 +1,7 @@
+using System;
+using System.Diagnostics.CodeAnalysis;
+using System.Runtime.InteropServices;
+
 namespace Evergreen.Physics.Backend.Jolt.Interop;
 
 public partial struct EgJoltContactArgs
@@ -19,4 +23,60 @@ public partial struct EgJoltContactArgs
 
     [NativeTypeName("EgJoltVector3")]
     public System.Numerics.Vector3 point2;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 normal;
+
+    public float penetrationDepth;
+
+    [NativeTypeName("unsigned int")]
+    public uint pointCount;
+
+    [NativeTypeName("EgJoltVector3[4]")]
+    public _points1_e__FixedBuffer points1;
+
+    [NativeTypeName("EgJoltVector3[4]")]
+    public _points2_e__FixedBuffer points2;
+
+    public EgJolt_ContactEvent contactEvent;
+
+    public partial struct _points1_e__FixedBuffer
+    {
+        public System.Numerics.Vector3 e0;
+        public System.Numerics.Vector3 e1;
+        public System.Numerics.Vector3 e2;
+        public System.Numerics.Vector3 e3;
+
+        [UnscopedRef]
+        public ref System.Numerics.Vector3 this[int index]
+        {
+            get
+            {
+                return ref AsSpan()[index];
+            }
+        }
+
+        [UnscopedRef]
+        public Span<System.Numerics.Vector3> AsSpan() => MemoryMarshal.CreateSpan(ref e0, 4);
+    }
+
+    public partial struct _points2_e__FixedBuffer
+    {
+        public System.Numerics.Vector3 e0;
+        public System.Numerics.Vector3 e1;
+        public System.Numerics.Vector3 e2;
+        public System.Numerics.Vector3 e3;
+
+        [UnscopedRef]
+        public ref System.Numerics.Vector3 this[int index]
+        {
+            get
+            {
+                return ref AsSpan()[index];
+            }
+        }
+
+        [UnscopedRef]
+        public Span<System.Numerics.Vector3> AsSpan() => MemoryMarshal.CreateSpan(ref e0, 4);
+    }
 }
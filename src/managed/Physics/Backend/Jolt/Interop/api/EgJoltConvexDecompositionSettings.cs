@@ -0,0 +1,14 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltConvexDecompositionSettings
+{
+    [NativeTypeName("unsigned int")]
+    public uint maxHulls;
+
+    [NativeTypeName("unsigned int")]
+    public uint maxVerticesPerHull;
+
+    public float maxConcavity;
+
+    public float density;
+}
@@ -0,0 +1,15 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public unsafe partial struct EgJoltConvexHullShapeSettings
+{
+    [NativeTypeName("const EgJoltVector3 *")]
+    public System.Numerics.Vector3* points;
+
+    [NativeTypeName("unsigned int")]
+    public uint pointCount;
+
+    [NativeTypeName("unsigned int")]
+    public uint maxVertexCount;
+
+    public float density;
+}
@@ -0,0 +1,10 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltDVector3
+{
+    public double x;
+
+    public double y;
+
+    public double z;
+}
@@ -0,0 +1,28 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public unsafe partial struct EgJoltHeightFieldShapeSettings
+{
+    [NativeTypeName("const float *")]
+    public float* samples;
+
+    [NativeTypeName("unsigned int")]
+    public uint sampleCount;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 offset;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 scale;
+
+    [NativeTypeName("unsigned int")]
+    public uint blockSize;
+
+    [NativeTypeName("unsigned int")]
+    public uint bitsPerSample;
+
+    [NativeTypeName("const unsigned char *")]
+    public byte* materialIndices;
+
+    [NativeTypeName("unsigned int")]
+    public uint materialCount;
+}
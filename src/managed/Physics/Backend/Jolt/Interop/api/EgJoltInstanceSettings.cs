@@ -0,0 +1,46 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltInstanceSettings
+{
+    [NativeTypeName("unsigned int")]
+    public uint maxBodies;
+
+    [NativeTypeName("unsigned int")]
+    public uint numBodyMutexes;
+
+    [NativeTypeName("unsigned int")]
+    public uint maxBodyPairs;
+
+    [NativeTypeName("unsigned int")]
+    public uint maxContactConstraints;
+
+    [NativeTypeName("unsigned int")]
+    public uint tempAllocatorSize;
+
+    public int threadCount;
+
+    public int collisionSteps;
+
+    public int numVelocitySteps;
+
+    public int numPositionSteps;
+
+    public float baumgarte;
+
+    public float speculativeContactDistance;
+
+    public float penetrationSlop;
+
+    public float timeBeforeSleep;
+
+    public float pointVelocitySleepThreshold;
+
+    [NativeTypeName("bool")]
+    public byte allowSleeping;
+
+    [NativeTypeName("bool")]
+    public byte deterministicSimulation;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong staticLayerMask;
+}
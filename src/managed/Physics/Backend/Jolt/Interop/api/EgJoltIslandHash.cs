@@ -0,0 +1,13 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltIslandHash
+{
+    [NativeTypeName("unsigned int")]
+    public uint bodyId;
+
+    [NativeTypeName("unsigned int")]
+    public uint bodyCount;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong hash;
+}
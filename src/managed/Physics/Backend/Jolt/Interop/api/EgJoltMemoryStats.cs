@@ -0,0 +1,25 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltMemoryStats
+{
+    [NativeTypeName("unsigned long long")]
+    public ulong heapBytes;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong heapPeakBytes;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong heapAllocationCount;
+
+    [NativeTypeName("unsigned int")]
+    public uint allHeapAllocationsDuringStep;
+
+    [NativeTypeName("unsigned int")]
+    public uint tempAllocatorSize;
+
+    [NativeTypeName("unsigned int")]
+    public uint tempAllocatorPeakBytes;
+
+    [NativeTypeName("unsigned int")]
+    public uint tempAllocatorOverflowCount;
+}
@@ -0,0 +1,10 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltOverlapHit
+{
+    [NativeTypeName("unsigned int")]
+    public uint bodyId;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong userData;
+}
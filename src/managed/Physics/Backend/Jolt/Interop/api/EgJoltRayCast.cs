@@ -0,0 +1,20 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltRayCast
+{
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 origin;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 direction;
+
+    public float maxDistance;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong layerMask;
+
+    [NativeTypeName("unsigned int")]
+    public uint ignoreBodyId;
+
+    public EgJolt_QueryFlags flags;
+}
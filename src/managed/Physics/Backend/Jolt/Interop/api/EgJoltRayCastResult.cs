@@ -0,0 +1,21 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltRayCastResult
+{
+    [NativeTypeName("unsigned int")]
+    public uint bodyId;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong userData;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 position;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 normal;
+
+    public float distance;
+
+    [NativeTypeName("bool")]
+    public byte hasHit;
+}
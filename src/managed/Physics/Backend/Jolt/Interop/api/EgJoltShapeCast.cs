@@ -0,0 +1,25 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltShapeCast
+{
+    public EgJoltShape shape;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 position;
+
+    [NativeTypeName("EgJoltQuaternion")]
+    public System.Numerics.Quaternion rotation;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 direction;
+
+    public float maxDistance;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong layerMask;
+
+    [NativeTypeName("unsigned int")]
+    public uint ignoreBodyId;
+
+    public EgJolt_QueryFlags flags;
+}
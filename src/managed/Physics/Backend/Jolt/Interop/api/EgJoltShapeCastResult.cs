@@ -0,0 +1,23 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltShapeCastResult
+{
+    [NativeTypeName("unsigned int")]
+    public uint bodyId;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong userData;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 position;
+
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 normal;
+
+    public float distance;
+
+    public float penetrationDepth;
+
+    [NativeTypeName("bool")]
+    public byte hasHit;
+}
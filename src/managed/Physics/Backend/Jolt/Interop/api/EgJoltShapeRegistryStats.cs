@@ -0,0 +1,19 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltShapeRegistryStats
+{
+    [NativeTypeName("unsigned int")]
+    public uint shapeCount;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong hitCount;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong missCount;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong memoryBytes;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong savedMemoryBytes;
+}
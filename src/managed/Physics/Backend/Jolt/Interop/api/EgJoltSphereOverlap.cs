@@ -0,0 +1,14 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltSphereOverlap
+{
+    [NativeTypeName("EgJoltVector3")]
+    public System.Numerics.Vector3 center;
+
+    public float radius;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong layerMask;
+
+    public EgJolt_QueryFlags flags;
+}
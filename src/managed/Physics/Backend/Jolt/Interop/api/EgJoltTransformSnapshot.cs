@@ -0,0 +1,19 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public unsafe partial struct EgJoltTransformSnapshot
+{
+    [NativeTypeName("unsigned int")]
+    public uint frame;
+
+    [NativeTypeName("unsigned int")]
+    public uint bodyCount;
+
+    [NativeTypeName("const unsigned int *")]
+    public uint* bodyIds;
+
+    [NativeTypeName("const EgJoltVector3 *")]
+    public System.Numerics.Vector3* positions;
+
+    [NativeTypeName("const EgJoltQuaternion *")]
+    public System.Numerics.Quaternion* rotations;
+}
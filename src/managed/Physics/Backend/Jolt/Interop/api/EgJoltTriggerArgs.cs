@@ -0,0 +1,21 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltTriggerArgs
+{
+    [NativeTypeName("unsigned int")]
+    public uint sensorBodyId;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong sensorUserData;
+
+    [NativeTypeName("unsigned int")]
+    public uint otherBodyId;
+
+    [NativeTypeName("unsigned long long")]
+    public ulong otherUserData;
+
+    [NativeTypeName("unsigned char")]
+    public byte otherLayer;
+
+    public EgJolt_TriggerEvent triggerEvent;
+}
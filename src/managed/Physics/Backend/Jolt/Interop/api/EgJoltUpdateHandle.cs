@@ -0,0 +1,6 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public unsafe partial struct EgJoltUpdateHandle
+{
+    public void* @internal;
+}
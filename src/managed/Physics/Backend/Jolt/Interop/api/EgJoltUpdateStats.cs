@@ -0,0 +1,22 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+public partial struct EgJoltUpdateStats
+{
+    public EgJolt_UpdateError errors;
+
+    [NativeTypeName("unsigned int")]
+    public uint tempAllocatorHighWaterMark;
+
+    [NativeTypeName("unsigned int")]
+    public uint activeBodyCount;
+
+    [NativeTypeName("unsigned int")]
+    public uint contactCount;
+
+    [NativeTypeName("unsigned int")]
+    public uint droppedContactEventCount;
+
+    public float stepMilliseconds;
+
+    public float contactsMilliseconds;
+}
@@ -0,0 +1,14 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+[NativeTypeName("unsigned char")]
+public enum EgJolt_AllowedDOFs : byte
+{
+    None = 0,
+    TranslationX = 1 << 0,
+    TranslationY = 1 << 1,
+    TranslationZ = 1 << 2,
+    RotationX = 1 << 3,
+    RotationY = 1 << 4,
+    RotationZ = 1 << 5,
+    All = 0x3F,
+}
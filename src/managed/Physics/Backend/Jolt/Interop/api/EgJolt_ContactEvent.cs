@@ -0,0 +1,9 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+[NativeTypeName("unsigned char")]
+public enum EgJolt_ContactEvent : byte
+{
+    Added = 0,
+    Persisted = 1,
+    Removed = 2,
+}
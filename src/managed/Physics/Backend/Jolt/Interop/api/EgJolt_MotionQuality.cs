@@ -0,0 +1,8 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+[NativeTypeName("unsigned char")]
+public enum EgJolt_MotionQuality : byte
+{
+    Discrete = 0,
+    LinearCast = 1,
+}
@@ -0,0 +1,9 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+[NativeTypeName("unsigned char")]
+public enum EgJolt_QueryFlags : byte
+{
+    None = 0,
+    AnyHit = 1 << 0,
+    BoundsOnly = 1 << 1,
+}
@@ -0,0 +1,8 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+[NativeTypeName("unsigned char")]
+public enum EgJolt_StateFlags : byte
+{
+    None = 0,
+    ActiveDynamicBodiesOnly = 1 << 0,
+}
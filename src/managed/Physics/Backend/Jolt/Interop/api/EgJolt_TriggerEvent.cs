@@ -0,0 +1,8 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+[NativeTypeName("unsigned char")]
+public enum EgJolt_TriggerEvent : byte
+{
+    Enter = 0,
+    Exit = 1,
+}
@@ -0,0 +1,10 @@
+namespace Evergreen.Physics.Backend.Jolt.Interop;
+
+[NativeTypeName("unsigned int")]
+public enum EgJolt_UpdateError : uint
+{
+    None = 0,
+    ManifoldCacheFull = 1 << 0,
+    BodyPairCacheFull = 1 << 1,
+    ContactConstraintsFull = 1 << 2,
+}
@@ -10,6 +10,21 @@ public static unsafe partial class Methods
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltSharedDestroy();
 
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltJobSystem egJoltCreateJobSystem(int threadCount, [NativeTypeName("unsigned long long")] ulong affinityMask, [NativeTypeName("unsigned int")] uint maxInstances);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltDestroyJobSystem(EgJoltJobSystem jobSystem);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltJobSystem egJoltGetDefaultJobSystem();
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern int egJoltJobSystemGetMaxConcurrency(EgJoltJobSystem jobSystem);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltJobSystemParallelFor(EgJoltJobSystem jobSystem, [NativeTypeName("unsigned int")] uint count, [NativeTypeName("unsigned int")] uint batchSize, [NativeTypeName("void (*)(void *, unsigned int, unsigned int)")] delegate* unmanaged[Cdecl]<void*, uint, uint, void> callback, void* userData);
+
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("unsigned int")]
     public static extern uint egJoltGetMaxBodies();
@@ -23,13 +38,43 @@ public static unsafe partial class Methods
     public static extern uint egJoltGetMaxContactConstraints();
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
-    public static extern EgJoltInstance egJoltCreateInstance([NativeTypeName("unsigned char")] byte maxNumberOfLayers, [NativeTypeName("void (*)(EgJoltContactArgs)")] delegate* unmanaged[Cdecl]<EgJoltContactArgs, void> callbackContactAdded, [NativeTypeName("void (*)(EgJoltContactArgs)")] delegate* unmanaged[Cdecl]<EgJoltContactArgs, void> callbackContactPersisted, [NativeTypeName("bool (*)(unsigned char, unsigned char)")] delegate* unmanaged[Cdecl]<byte, byte, byte> callbackShouldCollide);
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltGetMaxLayers();
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltIsDoublePrecision();
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltInstanceSettings egJoltGetDefaultInstanceSettings();
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltInstance egJoltCreateInstance([NativeTypeName("unsigned char")] byte maxNumberOfLayers, [NativeTypeName("void (*)(EgJoltContactArgs)")] delegate* unmanaged[Cdecl]<EgJoltContactArgs, void> callbackContactAdded, [NativeTypeName("void (*)(EgJoltContactArgs)")] delegate* unmanaged[Cdecl]<EgJoltContactArgs, void> callbackContactPersisted, [NativeTypeName("bool (*)(unsigned char, unsigned char)")] delegate* unmanaged[Cdecl]<byte, byte, byte> callbackShouldCollide, [NativeTypeName("const EgJoltInstanceSettings *")] EgJoltInstanceSettings* settings);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltDestroyInstance(EgJoltInstance instance);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
-    public static extern void egJoltUpdate(EgJoltInstance instance, float deltaTime, int collisionSteps);
+    public static extern EgJoltUpdateStats egJoltUpdate(EgJoltInstance instance, float deltaTime, int collisionSteps);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltUpdateHandle egJoltUpdateAsync(EgJoltInstance instance, float deltaTime, int collisionSteps);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltIsUpdateComplete(EgJoltUpdateHandle handle);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltUpdateStats egJoltWaitUpdate(EgJoltUpdateHandle handle);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltMemoryStats egJoltGetMemoryStats(EgJoltInstance instance);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltTransformSnapshot egJoltGetTransformSnapshot(EgJoltInstance instance);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltSetJobSystem(EgJoltInstance instance, EgJoltJobSystem jobSystem);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltSetGravity(EgJoltInstance instance, [NativeTypeName("EgJoltVector3")] System.Numerics.Vector3 gravity);
@@ -37,6 +82,55 @@ public static unsafe partial class Methods
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltOptimizeBroadPhase(EgJoltInstance instance);
 
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltSetLayerCollisionMatrix(EgJoltInstance instance, [NativeTypeName("const unsigned long long *")] ulong* masks, [NativeTypeName("unsigned int")] uint count);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltSetBroadPhaseLayers(EgJoltInstance instance, [NativeTypeName("const unsigned char *")] byte* broadPhaseLayers, [NativeTypeName("unsigned int")] uint count);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltDrainContacts(EgJoltInstance instance, EgJoltContactArgs* buffer, [NativeTypeName("unsigned int")] uint capacity);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltSetContactQueueCapacity(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint capacity);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltGetTriggerEvents(EgJoltInstance instance, [NativeTypeName("unsigned long long")] ulong layerMask, EgJoltTriggerArgs* events, [NativeTypeName("unsigned int")] uint capacity);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltGetActiveBodies(EgJoltInstance instance, [NativeTypeName("unsigned int *")] uint* bodyIds, [NativeTypeName("unsigned int")] uint capacity);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltGetActivationChanges(EgJoltInstance instance, EgJoltActivationChange* changes, [NativeTypeName("unsigned int")] uint capacity);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltSaveState(EgJoltInstance instance, EgJolt_StateFlags flags, void* buffer, [NativeTypeName("unsigned int")] uint bufferSize);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltRestoreState(EgJoltInstance instance, [NativeTypeName("const void *")] void* buffer, [NativeTypeName("unsigned int")] uint bufferSize);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltSetStateHistoryCapacity(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint frameCount);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltSaveStateToHistory(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint frame, EgJolt_StateFlags flags);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltRestoreStateFromHistory(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint frame);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned long long")]
+    public static extern ulong egJoltComputeStateHash(EgJoltInstance instance, [NativeTypeName("unsigned long long")] ulong layerMask, EgJoltIslandHash* islandHashes, [NativeTypeName("unsigned int")] uint islandCapacity, [NativeTypeName("unsigned int *")] uint* islandCount);
+
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("bool")]
     public static extern byte egJoltCreateBoxShape(EgJoltBoxShapeSettings settings, EgJoltShape* outShape);
@@ -59,11 +153,98 @@ public static unsafe partial class Methods
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("bool")]
-    public static extern byte egJoltCreateStaticBody(EgJoltInstance instance, EgJoltShape shape, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state);
+    public static extern byte egJoltCreateConvexHullShape(EgJoltConvexHullShapeSettings settings, EgJoltShape* outShape);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltCreateConvexDecompositionShape(EgJoltMesh mesh, EgJoltConvexDecompositionSettings settings, EgJoltShape* outShape);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltCreateHeightFieldShape(EgJoltHeightFieldShapeSettings settings, EgJoltShape* outShape);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltSetHeightFieldHeights(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId, [NativeTypeName("unsigned int")] uint x, [NativeTypeName("unsigned int")] uint y, [NativeTypeName("unsigned int")] uint sizeX, [NativeTypeName("unsigned int")] uint sizeY, [NativeTypeName("const float *")] float* heights);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltShapeRegistryStats egJoltGetShapeRegistryStats();
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltPruneShapeRegistry();
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltCreateCompoundMeshShape(EgJoltCompoundMesh compoundMesh, EgJoltShape* outShape);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned long long")]
+    public static extern ulong egJoltHashMesh([NativeTypeName("const EgJoltVector3 *")] System.Numerics.Vector3* vertices, [NativeTypeName("unsigned int")] uint vertexCount, [NativeTypeName("const unsigned int *")] uint* indices, [NativeTypeName("unsigned int")] uint indexCount);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned long long")]
+    public static extern ulong egJoltHashCompoundMesh(EgJoltCompoundMesh compoundMesh);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltSaveShape(EgJoltShape shape, [NativeTypeName("unsigned long long")] ulong contentHash, void* buffer, [NativeTypeName("unsigned int")] uint bufferSize);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltLoadShapeFromMemory([NativeTypeName("const void *")] void* buffer, [NativeTypeName("unsigned int")] uint bufferSize, [NativeTypeName("unsigned long long")] ulong contentHash, EgJoltShape* outShape);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltBodyCreationOptions egJoltGetDefaultBodyCreationOptions();
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltCreateStaticBody(EgJoltInstance instance, EgJoltShape shape, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltCreateDynamicBody(EgJoltInstance instance, EgJoltShape shape, float mass, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltCreateStaticBodies(EgJoltInstance instance, [NativeTypeName("const EgJoltShape *")] EgJoltShape* shapes, [NativeTypeName("const unsigned long long *")] ulong* userData, [NativeTypeName("const EgJoltBodyState *")] EgJoltBodyState* states, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options, [NativeTypeName("unsigned int")] uint count, [NativeTypeName("unsigned int *")] uint* bodyIds);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltCreateDynamicBodies(EgJoltInstance instance, [NativeTypeName("const EgJoltShape *")] EgJoltShape* shapes, [NativeTypeName("const float *")] float* masses, [NativeTypeName("const unsigned long long *")] ulong* userData, [NativeTypeName("const EgJoltBodyState *")] EgJoltBodyState* states, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options, [NativeTypeName("unsigned int")] uint count, [NativeTypeName("unsigned int *")] uint* bodyIds);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltExportScene(EgJoltInstance instance, [NativeTypeName("unsigned long long")] ulong layerMask, void* buffer, [NativeTypeName("unsigned int")] uint bufferSize);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltGetSceneBodyCount([NativeTypeName("const void *")] void* buffer, [NativeTypeName("unsigned int")] uint bufferSize);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltImportScene(EgJoltInstance instance, [NativeTypeName("const void *")] void* buffer, [NativeTypeName("unsigned int")] uint bufferSize, [NativeTypeName("unsigned int *")] uint* bodyIds, [NativeTypeName("unsigned int")] uint bodyIdCapacity, [NativeTypeName("unsigned int *")] uint* bodyCount);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltBodyPool egJoltCreateBodyPool(EgJoltInstance instance, EgJoltShape shape, float mass, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options, [NativeTypeName("unsigned int")] uint count);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltDestroyBodyPool(EgJoltInstance instance, EgJoltBodyPool pool);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltGetBodyPoolFreeCount(EgJoltBodyPool pool);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltAcquirePooledBody(EgJoltInstance instance, EgJoltBodyPool pool, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("const EgJoltBodyState *")] EgJoltBodyState* state);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("bool")]
-    public static extern byte egJoltCreateDynamicBody(EgJoltInstance instance, EgJoltShape shape, float mass, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state);
+    public static extern byte egJoltReleasePooledBody(EgJoltInstance instance, EgJoltBodyPool pool, [NativeTypeName("unsigned int")] uint bodyId);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltFlushBodyPools(EgJoltInstance instance);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("unsigned int")]
@@ -73,6 +254,10 @@ public static unsafe partial class Methods
     [return: NativeTypeName("bool")]
     public static extern byte egJoltAreBodiesColliding(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId1, [NativeTypeName("unsigned int")] uint bodyId2);
 
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltAreBodiesCollidingMany(EgJoltInstance instance, [NativeTypeName("const unsigned int *")] uint* bodyIds1, [NativeTypeName("const unsigned int *")] uint* bodyIds2, [NativeTypeName("unsigned int")] uint count, [NativeTypeName("bool *")] byte* results);
+
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJolt_Body_InvalidateContactCache(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId);
 
@@ -81,23 +266,23 @@ public static unsafe partial class Methods
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("unsigned int")]
-    public static extern uint egJoltAddBodyDynamicBox(EgJoltInstance instance, [NativeTypeName("EgJoltVector3")] System.Numerics.Vector3 scale, float density, float mass, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state);
+    public static extern uint egJoltAddBodyDynamicBox(EgJoltInstance instance, [NativeTypeName("EgJoltVector3")] System.Numerics.Vector3 scale, float density, float mass, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("unsigned int")]
-    public static extern uint egJoltAddBodyDynamicSphere(EgJoltInstance instance, float radius, float density, float mass, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state);
+    public static extern uint egJoltAddBodyDynamicSphere(EgJoltInstance instance, float radius, float density, float mass, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("unsigned int")]
-    public static extern uint egJoltAddBodyStaticBox(EgJoltInstance instance, [NativeTypeName("EgJoltVector3")] System.Numerics.Vector3 scale, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state);
+    public static extern uint egJoltAddBodyStaticBox(EgJoltInstance instance, [NativeTypeName("EgJoltVector3")] System.Numerics.Vector3 scale, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("unsigned int")]
-    public static extern uint egJoltAddBodyStaticMesh(EgJoltInstance instance, [NativeTypeName("EgJoltVector3 *")] System.Numerics.Vector3* vertices, int vertexCount, [NativeTypeName("unsigned int *")] uint* indices, int indexCount, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state);
+    public static extern uint egJoltAddBodyStaticMesh(EgJoltInstance instance, [NativeTypeName("EgJoltVector3 *")] System.Numerics.Vector3* vertices, int vertexCount, [NativeTypeName("unsigned int *")] uint* indices, int indexCount, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("unsigned int")]
-    public static extern uint egJoltAddBodyStaticCompoundMesh(EgJoltInstance instance, EgJoltCompoundMesh compoundMesh, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state);
+    public static extern uint egJoltAddBodyStaticCompoundMesh(EgJoltInstance instance, EgJoltCompoundMesh compoundMesh, [NativeTypeName("unsigned long long")] ulong userData, [NativeTypeName("unsigned int *")] uint* bodyId, EgJoltBodyState* state, [NativeTypeName("const EgJoltBodyCreationOptions *")] EgJoltBodyCreationOptions* options);
 
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltActivateBody(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId);
@@ -108,6 +293,9 @@ public static unsafe partial class Methods
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltRemoveBody(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId);
 
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltRemoveBodies(EgJoltInstance instance, [NativeTypeName("const unsigned int *")] uint* bodyIds, [NativeTypeName("unsigned int")] uint bodyCount);
+
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("bool")]
     public static extern byte egJoltIsBodyActive(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId);
@@ -125,6 +313,21 @@ public static unsafe partial class Methods
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltSetBodyUserData(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId, [NativeTypeName("unsigned long long")] ulong userData);
 
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltShiftOrigin(EgJoltInstance instance, EgJoltDVector3 offset);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltSetBodyPositionD(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId, EgJoltDVector3 position);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltDVector3 egJoltGetBodyPositionD(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltSetBodyPositionAndRotationD(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId, EgJoltDVector3 position, [NativeTypeName("EgJoltQuaternion")] System.Numerics.Quaternion rotation);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltGetBodyPositionAndRotationD(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId, [NativeTypeName("EgJoltDVector3 &")] EgJoltDVector3* position, [NativeTypeName("EgJoltQuaternion &")] System.Numerics.Quaternion* rotation);
+
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltSetBodyPosition(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId, [NativeTypeName("EgJoltVector3")] System.Numerics.Vector3 position);
 
@@ -179,6 +382,12 @@ public static unsafe partial class Methods
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJolt_CharacterVirtual_SetPosition(EgJoltInstance instance, EgJoltCharacterVirtual character, [NativeTypeName("EgJoltVector3")] System.Numerics.Vector3 position);
 
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltDVector3 egJoltGetCharacterVirtualPositionD(EgJoltInstance instance, EgJoltCharacterVirtual character);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJolt_CharacterVirtual_SetPositionD(EgJoltInstance instance, EgJoltCharacterVirtual character, EgJoltDVector3 position);
+
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJolt_CharacterVirtual_RefreshContacts(EgJoltInstance instance, EgJoltCharacterVirtual character, [NativeTypeName("unsigned char")] byte layer);
 
@@ -212,6 +421,9 @@ public static unsafe partial class Methods
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltUpdateCharacterVirtual(EgJoltInstance instance, EgJoltCharacterVirtual character, float deltaTime, [NativeTypeName("EgJoltCharacterVirtualUpdateSettings &")] EgJoltCharacterVirtualUpdateSettings* updateSettings);
 
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltUpdateCharacterVirtuals(EgJoltInstance instance, [NativeTypeName("const EgJoltCharacterVirtual *")] EgJoltCharacterVirtual* characters, [NativeTypeName("unsigned int")] uint count, [NativeTypeName("EgJoltCharacterVirtualUpdateSettings &")] EgJoltCharacterVirtualUpdateSettings* updateSettings, float deltaTime);
+
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltGetCharacterVirtualActiveDynamicContacts(EgJoltInstance instance, EgJoltCharacterVirtual character, [NativeTypeName("void (*)(unsigned int)")] delegate* unmanaged[Cdecl]<uint, void> callbackContact);
 
@@ -235,6 +447,12 @@ public static unsafe partial class Methods
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJoltSetCharacterPosition(EgJoltInstance instance, EgJoltCharacter character, [NativeTypeName("EgJoltVector3")] System.Numerics.Vector3 position);
 
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern EgJoltDVector3 egJoltGetCharacterPositionD(EgJoltInstance instance, EgJoltCharacter character);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltSetCharacterPositionD(EgJoltInstance instance, EgJoltCharacter character, EgJoltDVector3 position);
+
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     [return: NativeTypeName("EgJoltVector3")]
     public static extern System.Numerics.Vector3 egJoltGetCharacterLinearVelocity(EgJoltInstance instance, EgJoltCharacter character);
@@ -259,6 +477,44 @@ public static unsafe partial class Methods
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern void egJolt_Body_SetState([NativeTypeName("const EgJoltInstance")] EgJoltInstance instance, [NativeTypeName("unsigned int")] uint bodyId, [NativeTypeName("const EgJoltBodyState *")] EgJoltBodyState* state);
 
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJolt_Bodies_GetStates([NativeTypeName("const EgJoltInstance")] EgJoltInstance instance, [NativeTypeName("const unsigned int *")] uint* bodyIds, [NativeTypeName("unsigned int")] uint bodyCount, EgJoltBodyStates* states);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJolt_Bodies_SetStates([NativeTypeName("const EgJoltInstance")] EgJoltInstance instance, [NativeTypeName("const unsigned int *")] uint* bodyIds, [NativeTypeName("unsigned int")] uint bodyCount, [NativeTypeName("const EgJoltBodyStates *")] EgJoltBodyStates* states);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltCastRays(EgJoltInstance instance, [NativeTypeName("const EgJoltRayCast *")] EgJoltRayCast* rayCasts, [NativeTypeName("unsigned int")] uint count, EgJoltRayCastResult* results);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltCastShapes(EgJoltInstance instance, [NativeTypeName("const EgJoltShapeCast *")] EgJoltShapeCast* shapeCasts, [NativeTypeName("unsigned int")] uint count, EgJoltShapeCastResult* results);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltOverlapSpheres(EgJoltInstance instance, [NativeTypeName("const EgJoltSphereOverlap *")] EgJoltSphereOverlap* overlaps, [NativeTypeName("unsigned int")] uint count, EgJoltOverlapHit* hits, [NativeTypeName("unsigned int")] uint hitCapacity, [NativeTypeName("unsigned int *")] uint* hitOffsets);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltOverlapBoxes(EgJoltInstance instance, [NativeTypeName("const EgJoltBoxOverlap *")] EgJoltBoxOverlap* overlaps, [NativeTypeName("unsigned int")] uint count, EgJoltOverlapHit* hits, [NativeTypeName("unsigned int")] uint hitCapacity, [NativeTypeName("unsigned int *")] uint* hitOffsets);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltSetLagCompensationCapacity(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint tickCount);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    public static extern void egJoltSetLagCompensatedBodies(EgJoltInstance instance, [NativeTypeName("const unsigned int *")] uint* bodyIds, [NativeTypeName("unsigned int")] uint count);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("bool")]
+    public static extern byte egJoltRecordLagCompensationTick(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint tick);
+
+    [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
+    [return: NativeTypeName("unsigned int")]
+    public static extern uint egJoltCastRaysAtTick(EgJoltInstance instance, [NativeTypeName("unsigned int")] uint tick, [NativeTypeName("const EgJoltRayCast *")] EgJoltRayCast* rayCasts, [NativeTypeName("unsigned int")] uint count, EgJoltRayCastResult* results);
+
     [DllImport("Evergreen.Physics.Native.dll", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
     public static extern int egJolt_Vector3_IsNearZero([NativeTypeName("EgJoltVector3")] System.Numerics.Vector3 v);
 
@@ -7,12 +7,23 @@
 #include <Jolt/RegisterTypes.h>
 #include <Jolt/Core/Factory.h>
 #include <Jolt/Core/TempAllocator.h>
-#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/Semaphore.h>
+#include <Jolt/Core/FPException.h>
+#include <Jolt/Core/UnorderedSet.h>
+#include <Jolt/Core/UnorderedMap.h>
+#include <Jolt/Core/HashCombine.h>
+#include <Jolt/Core/QuickSort.h>
 #include <Jolt/Physics/PhysicsSettings.h>
 #include <Jolt/Physics/PhysicsSystem.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
 #include <Jolt/Physics/Collision/Shape/MeshShape.h>
+#include <Jolt/Physics/Collision/Shape/HeightFieldShape.h>
+#include <Jolt/Physics/Collision/Shape/ConvexHullShape.h>
+#include <Jolt/Geometry/ConvexHullBuilder.h>
+#include <Jolt/Physics/Collision/PhysicsMaterialSimple.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 #include <Jolt/Physics/Character/Character.h>
@@ -22,15 +33,38 @@
 #include <Jolt/Physics/Collision/ShapeCast.h>
 #include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
 #include <Jolt/Physics/Collision/RayCast.h>
+#include <Jolt/Physics/Collision/CastResult.h>
 #include <Jolt/Physics/Collision/ShapeCast.h>
 #include <Jolt/Physics/Collision/Shape/StaticCompoundShape.h>
+#include <Jolt/Physics/Collision/TransformedShape.h>
+#include <Jolt/Geometry/RayAABox.h>
+#include <Jolt/Geometry/OrientedBox.h>
+#include <Jolt/Physics/Collision/CollideShape.h>
 #include <Jolt/Physics/Body/BodyLock.h>
+#include <Jolt/Physics/StateRecorder.h>
+#include <Jolt/Physics/PhysicsScene.h>
 
 // STL includes
 #include <iostream>
 #include <cstdarg>
 #include <thread>
+#include <chrono>
 #include <cassert>
+#include <cstring>
+#include <mutex>
+
+#if defined(JPH_PLATFORM_WINDOWS)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#elif defined(JPH_PLATFORM_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "egJolt.h"
 
@@ -46,7 +80,7 @@ using namespace JPH::literals;
 // We're also using STL classes in this example
 using namespace std;
 
-inline EgJoltVector3 ConvertVector3(RVec3 v)
+inline EgJoltVector3 ConvertVector3(Vec3 v)
 {
 	EgJoltVector3 result = {};
 	result.x = v.GetX();
@@ -55,11 +89,42 @@ inline EgJoltVector3 ConvertVector3(RVec3 v)
 	return result;
 }
 
-inline RVec3 ConvertVector3(EgJoltVector3 v)
+inline Vec3 ConvertVector3(EgJoltVector3 v)
+{
+	return Vec3(v.x, v.y, v.z);
+}
+
+// Positions. With JPH_DOUBLE_PRECISION the float API rounds them, the EgJoltDVector3 variants keep the full precision.
+#ifdef JPH_DOUBLE_PRECISION
+inline EgJoltVector3 ConvertVector3(DVec3 v)
+{
+	EgJoltVector3 result = {};
+	result.x = (float)v.GetX();
+	result.y = (float)v.GetY();
+	result.z = (float)v.GetZ();
+	return result;
+}
+#endif // JPH_DOUBLE_PRECISION
+
+inline RVec3 ConvertRVec3(EgJoltVector3 v)
 {
 	return RVec3(v.x, v.y, v.z);
 }
 
+inline EgJoltDVector3 ConvertDVector3(RVec3 v)
+{
+	EgJoltDVector3 result = {};
+	result.x = v.GetX();
+	result.y = v.GetY();
+	result.z = v.GetZ();
+	return result;
+}
+
+inline RVec3 ConvertRVec3(EgJoltDVector3 v)
+{
+	return RVec3(Real(v.x), Real(v.y), Real(v.z));
+}
+
 inline EgJoltVector4 ConvertVector4(Vec4 v)
 {
 	EgJoltVector4 result = {};
@@ -95,6 +160,11 @@ inline BodyID ConvertBodyId(unsigned int bodyId)
 	return *(BodyID const*)&bodyId;
 }
 
+inline unsigned int ConvertBodyId(BodyID bodyId)
+{
+	return bodyId.GetIndexAndSequenceNumber();
+}
+
 // Callback for traces, connect this to your own trace function if you have one
 static void TraceImpl(const char* inFMT, ...)
 {
@@ -123,15 +193,180 @@ static bool AssertFailedImpl(const char* inExpression, const char* inMessage, co
 
 #endif // JPH_ENABLE_ASSERTS
 
+#ifndef JPH_DISABLE_CUSTOM_ALLOCATOR
+
+/// Counts the bytes that go through Jolt's allocator. Every block starts with a header holding its size,
+/// and for aligned blocks also the distance back to the start of the underlying allocation.
+struct EgJoltHeapHeader
+{
+	size_t size;
+	size_t offset;
+};
+
+static constexpr size_t cHeapHeaderSize = 16;		// Keeps the default allocation alignment of Jolt
+static_assert(sizeof(EgJoltHeapHeader) <= cHeapHeaderSize);
+
+static AllocateFunction s_heapAllocate = nullptr;
+static ReallocateFunction s_heapReallocate = nullptr;
+static FreeFunction s_heapFree = nullptr;
+static AlignedAllocateFunction s_heapAlignedAllocate = nullptr;
+static AlignedFreeFunction s_heapAlignedFree = nullptr;
+
+static atomic<uint64> s_heapBytes = 0;
+static atomic<uint64> s_heapPeakBytes = 0;
+static atomic<uint64> s_heapAllocationCount = 0;
+
+inline EgJoltHeapHeader* _egJoltGetHeapHeader(void* block)
+{
+	return (EgJoltHeapHeader*)((uint8*)block - sizeof(EgJoltHeapHeader));
+}
+
+inline void _egJoltTrackHeapAllocation(size_t size)
+{
+	uint64 bytes = s_heapBytes.fetch_add(size, memory_order_relaxed) + size;
+	uint64 peakBytes = s_heapPeakBytes.load(memory_order_relaxed);
+	while (bytes > peakBytes && !s_heapPeakBytes.compare_exchange_weak(peakBytes, bytes, memory_order_relaxed)) {}
+	s_heapAllocationCount.fetch_add(1, memory_order_relaxed);
+}
+
+static void* TrackedAllocateImpl(size_t inSize)
+{
+	uint8* base = (uint8*)s_heapAllocate(inSize + cHeapHeaderSize);
+	if (!base)
+		return nullptr;
+
+	void* block = base + cHeapHeaderSize;
+	*_egJoltGetHeapHeader(block) = { inSize, cHeapHeaderSize };
+	_egJoltTrackHeapAllocation(inSize);
+	return block;
+}
+
+static void* TrackedReallocateImpl(void* inBlock, size_t inOldSize, size_t inNewSize)
+{
+	if (!inBlock)
+		return TrackedAllocateImpl(inNewSize);
+
+	size_t oldSize = _egJoltGetHeapHeader(inBlock)->size;
+	uint8* base = (uint8*)s_heapReallocate((uint8*)inBlock - cHeapHeaderSize, oldSize + cHeapHeaderSize, inNewSize + cHeapHeaderSize);
+	if (!base)
+		return nullptr;
+
+	void* block = base + cHeapHeaderSize;
+	*_egJoltGetHeapHeader(block) = { inNewSize, cHeapHeaderSize };
+	s_heapBytes.fetch_sub(oldSize, memory_order_relaxed);
+	_egJoltTrackHeapAllocation(inNewSize);
+	return block;
+}
+
+static void TrackedFreeImpl(void* inBlock)
+{
+	if (!inBlock)
+		return;
+
+	s_heapBytes.fetch_sub(_egJoltGetHeapHeader(inBlock)->size, memory_order_relaxed);
+	s_heapFree((uint8*)inBlock - cHeapHeaderSize);
+}
+
+static void* TrackedAlignedAllocateImpl(size_t inSize, size_t inAlignment)
+{
+	// The header takes a whole multiple of the alignment so the block stays aligned
+	size_t headerSize = AlignUp(cHeapHeaderSize, inAlignment);
+	uint8* base = (uint8*)s_heapAlignedAllocate(inSize + headerSize, inAlignment);
+	if (!base)
+		return nullptr;
+
+	void* block = base + headerSize;
+	*_egJoltGetHeapHeader(block) = { inSize, headerSize };
+	_egJoltTrackHeapAllocation(inSize);
+	return block;
+}
+
+static void TrackedAlignedFreeImpl(void* inBlock)
+{
+	if (!inBlock)
+		return;
+
+	EgJoltHeapHeader* header = _egJoltGetHeapHeader(inBlock);
+	s_heapBytes.fetch_sub(header->size, memory_order_relaxed);
+	s_heapAlignedFree((uint8*)inBlock - header->offset);
+}
+
+// Wraps the allocation functions that are registered at the time of the call
+static void RegisterTrackedAllocator()
+{
+	s_heapAllocate = Allocate;
+	s_heapReallocate = Reallocate;
+	s_heapFree = Free;
+	s_heapAlignedAllocate = AlignedAllocate;
+	s_heapAlignedFree = AlignedFree;
+
+	Allocate = TrackedAllocateImpl;
+	Reallocate = TrackedReallocateImpl;
+	Free = TrackedFreeImpl;
+	AlignedAllocate = TrackedAlignedAllocateImpl;
+	AlignedFree = TrackedAlignedFreeImpl;
+}
+
+#else
+
+static atomic<uint64> s_heapBytes = 0;
+static atomic<uint64> s_heapPeakBytes = 0;
+static atomic<uint64> s_heapAllocationCount = 0;
+
+static void RegisterTrackedAllocator() {}
+
+#endif // JPH_DISABLE_CUSTOM_ALLOCATOR
+
+/// Which object layers collide with each other and which broadphase layer every object layer lives in.
+/// Kept as bitmasks so the layer tests in Jolt's broadphase and narrowphase loops stay a couple of instructions.
+struct EgJoltLayerMatrix
+{
+	static constexpr unsigned int MaxLayers = 64;
+
+	unsigned char layerCount;
+	uint64 collisionMasks[MaxLayers];		// Bit N set = collides with object layer N
+	unsigned char broadPhaseLayers[MaxLayers];
+	uint64 broadPhaseMasks[MaxLayers];		// Bit N set = collides with something in broadphase layer N
+
+	void UpdateBroadPhaseMasks()
+	{
+		for (unsigned int i = 0; i < layerCount; i++)
+		{
+			uint64 mask = 0;
+			for (unsigned int j = 0; j < layerCount; j++)
+			{
+				if (collisionMasks[i] & (uint64(1) << j))
+				{
+					mask |= uint64(1) << broadPhaseLayers[j];
+				}
+			}
+			broadPhaseMasks[i] = mask;
+		}
+	}
+
+	uint64 GetBroadPhaseMask(uint64 objectLayerMask) const
+	{
+		uint64 mask = 0;
+		for (unsigned int i = 0; i < layerCount; i++)
+		{
+			if (objectLayerMask & (uint64(1) << i))
+			{
+				mask |= uint64(1) << broadPhaseLayers[i];
+			}
+		}
+		return mask;
+	}
+};
+
 /// Class that determines if two object layers can collide
 class ObjectLayerPairFilterImpl : public ObjectLayerPairFilter
 {
 public:
-	bool(*callbackShouldCollide)(unsigned char layer1, unsigned char layer2);
+	const EgJoltLayerMatrix* layerMatrix;
 
 	virtual bool ShouldCollide(ObjectLayer inObject1, ObjectLayer inObject2) const override
 	{
-		return callbackShouldCollide(inObject1, inObject2);
+		return (layerMatrix->collisionMasks[inObject1] & (uint64(1) << inObject2)) != 0;
 	}
 };
 
@@ -140,17 +375,18 @@ public:
 class BPLayerInterfaceImpl final : public BroadPhaseLayerInterface
 {
 public:
-	unsigned char maxNumberOfLayers;
+	const EgJoltLayerMatrix* layerMatrix;
 
+	// Room for a tree per object layer so egJoltSetBroadPhaseLayers can still spread the layers out, trees that no layer maps to stay empty
 	virtual uint GetNumBroadPhaseLayers() const override
 	{
-		return maxNumberOfLayers;
+		return layerMatrix->layerCount;
 	}
 
 	virtual BroadPhaseLayer	GetBroadPhaseLayer(ObjectLayer inLayer) const override
 	{
-		JPH_ASSERT(inLayer < maxNumberOfLayers);
-		return (BroadPhaseLayer)inLayer;
+		JPH_ASSERT(inLayer < layerMatrix->layerCount);
+		return (BroadPhaseLayer)layerMatrix->broadPhaseLayers[inLayer];
 	}
 
 #if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
@@ -165,11 +401,11 @@ public:
 class ObjectVsBroadPhaseLayerFilterImpl : public ObjectVsBroadPhaseLayerFilter
 {
 public:
-	bool(*callbackShouldCollide)(unsigned char layer1, unsigned char layer2);
+	const EgJoltLayerMatrix* layerMatrix;
 
 	virtual bool ShouldCollide(ObjectLayer inLayer1, BroadPhaseLayer inLayer2) const override
 	{
-		return callbackShouldCollide(inLayer1, (unsigned char)inLayer2);
+		return (layerMatrix->broadPhaseMasks[inLayer1] & (uint64(1) << (BroadPhaseLayer::Type)inLayer2)) != 0;
 	}
 };
 
@@ -177,12 +413,185 @@ class MyBodyFilter : public BodyFilter
 {
 };
 
+/// Object layer filter for queries, built from a caller supplied object layer mask
+class EgJoltLayerMaskFilter final : public ObjectLayerFilter
+{
+public:
+	explicit EgJoltLayerMaskFilter(uint64 mask) : mask(mask) {}
+
+	virtual bool ShouldCollide(ObjectLayer inLayer) const override
+	{
+		return (mask & (uint64(1) << inLayer)) != 0;
+	}
+
+private:
+	uint64 mask;
+};
+
+/// Broadphase layer filter for queries, skips the broadphase trees that hold none of the requested object layers
+class EgJoltBroadPhaseLayerMaskFilter final : public BroadPhaseLayerFilter
+{
+public:
+	explicit EgJoltBroadPhaseLayerMaskFilter(uint64 mask) : mask(mask) {}
+
+	virtual bool ShouldCollide(BroadPhaseLayer inLayer) const override
+	{
+		return (mask & (uint64(1) << (BroadPhaseLayer::Type)inLayer)) != 0;
+	}
+
+private:
+	uint64 mask;
+};
+
+/// Preallocated queue of contact events. Jolt calls the contact listener from its job threads,
+/// so writers only reserve a slot with an atomic increment and never block each other.
+class EgJoltContactQueue
+{
+public:
+	void SetCapacity(unsigned int capacity)
+	{
+		events.resize(capacity);
+		Clear();
+	}
+
+	void Clear()
+	{
+		count = 0;
+		readIndex = 0;
+	}
+
+	// Called before every step. After a step that dropped events the queue grows to fit all of them, so events are only dropped in the step of a spike.
+	void Reset()
+	{
+		unsigned int pushedCount = count.load(memory_order_relaxed);
+		if (pushedCount > events.size())
+		{
+			events.resize(pushedCount + pushedCount / 4);
+		}
+		Clear();
+	}
+
+	void Push(const EgJoltContactArgs& args)
+	{
+		unsigned int index = count.fetch_add(1, memory_order_relaxed);
+		if (index < events.size())
+		{
+			events[index] = args;
+		}
+	}
+
+	unsigned int GetCount() const
+	{
+		return min(count.load(memory_order_relaxed), (unsigned int)events.size());
+	}
+
+	unsigned int GetDroppedCount() const
+	{
+		return count.load(memory_order_relaxed) - GetCount();
+	}
+
+	Array<EgJoltContactArgs> events;
+	atomic<unsigned int> count = 0;
+	unsigned int readIndex = 0;
+};
+
+/// Contact events that sensor overlaps are derived from. Unlike the contact queue this never drops an event, since a lost removal would keep a body inside a sensor forever.
+/// Writers reserve a slot with an atomic increment like they do in the contact queue, events beyond the preallocated slots go to an array behind a mutex.
+class EgJoltSensorContactLog
+{
+public:
+	struct Entry
+	{
+		unsigned int bodyId1;
+		unsigned int bodyId2;
+		bool isAdded;
+	};
+
+	void SetCapacity(unsigned int capacity)
+	{
+		entries.resize(capacity);
+		Reset();
+	}
+
+	// Called before every step. Events that went to the overflow array get a preallocated slot from the next step on.
+	void Reset()
+	{
+		unsigned int pushedCount = count.load(memory_order_relaxed);
+		if (pushedCount > entries.size())
+		{
+			entries.resize(pushedCount + pushedCount / 4);
+		}
+		count = 0;
+		overflow.clear();
+	}
+
+	void Push(const BodyID& bodyId1, const BodyID& bodyId2, bool isAdded)
+	{
+		Entry entry = { ConvertBodyId(bodyId1), ConvertBodyId(bodyId2), isAdded };
+		unsigned int index = count.fetch_add(1, memory_order_relaxed);
+		if (index < entries.size())
+		{
+			entries[index] = entry;
+			return;
+		}
+
+		lock_guard<mutex> lock(overflowMutex);
+		overflow.push_back(entry);
+	}
+
+	// Only valid once the step is done. Slots are handed out in order, so the overflow array continues where the preallocated slots end.
+	template <typename F>
+	void ForEach(F&& function) const
+	{
+		unsigned int count = min(this->count.load(memory_order_relaxed), (unsigned int)entries.size());
+		for (unsigned int i = 0; i < count; i++)
+		{
+			function(entries[i]);
+		}
+		for (const Entry& entry : overflow)
+		{
+			function(entry);
+		}
+	}
+
+private:
+	Array<Entry> entries;
+	atomic<unsigned int> count = 0;
+	mutex overflowMutex;
+	Array<Entry> overflow;
+};
+
+inline EgJoltContactArgs _egJoltCreateContactArgs(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold, EgJolt_ContactEvent contactEvent)
+{
+	EgJoltContactArgs args = {};
+	args.bodyId1 = ConvertBodyId(inBody1.GetID());
+	args.userData1 = inBody1.GetUserData();
+	args.point1 = ConvertVector3(inManifold.GetWorldSpaceContactPointOn1(0));
+	args.bodyId2 = ConvertBodyId(inBody2.GetID());
+	args.userData2 = inBody2.GetUserData();
+	args.point2 = ConvertVector3(inManifold.GetWorldSpaceContactPointOn2(0));
+	args.normal = ConvertVector3(inManifold.mWorldSpaceNormal);
+	args.penetrationDepth = inManifold.mPenetrationDepth;
+	args.contactEvent = contactEvent;
+
+	// Manifold reduction keeps this at 4 points or less, anything beyond that is dropped.
+	args.pointCount = min((unsigned int)inManifold.mRelativeContactPointsOn1.size(), (unsigned int)size(args.points1));
+	for (unsigned int i = 0; i < args.pointCount; i++)
+	{
+		args.points1[i] = ConvertVector3(inManifold.GetWorldSpaceContactPointOn1(i));
+		args.points2[i] = ConvertVector3(inManifold.GetWorldSpaceContactPointOn2(i));
+	}
+
+	return args;
+}
+
 class MyContactListener : public ContactListener
 {
 public:
 	PhysicsSystem* physics;
-	void(*callbackContactAdded)(EgJoltContactArgs);
-	void(*callbackContactPersisted)(EgJoltContactArgs);
+	EgJoltContactQueue contactQueue;
+	EgJoltSensorContactLog sensorContactLog;
+	atomic<unsigned int> contactCount = 0;
 
 	virtual ValidateResult OnContactValidate(const Body& inBody1, const Body& inBody2, RVec3Arg inBaseOffset, const CollideShapeResult& inCollisionResult) override
 	{
@@ -195,61 +604,70 @@ public:
 
 	virtual void OnContactAdded(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold, ContactSettings& ioSettings) override
 	{
-		if (callbackContactAdded)
+		contactCount.fetch_add(1, memory_order_relaxed);
+		contactQueue.Push(_egJoltCreateContactArgs(inBody1, inBody2, inManifold, EgJolt_ContactEvent_Added));
+		if (inBody1.IsSensor() || inBody2.IsSensor())
 		{
-			auto bodyId1 = inBody1.GetID();
-			auto bodyId2 = inBody2.GetID();
-			auto userData1 = inBody1.GetUserData();
-			auto userData2 = inBody2.GetUserData();
-
-			EgJoltContactArgs args;
-			args.bodyId1 = *(unsigned int*)&bodyId1;
-			args.userData1 = userData1;
-			args.point1 = ConvertVector3(inManifold.GetWorldSpaceContactPointOn1(0));
-			args.bodyId2 = *(unsigned int*)&bodyId2;
-			args.userData2 = userData2;
-			args.point2 = ConvertVector3(inManifold.GetWorldSpaceContactPointOn2(0));
-
-			callbackContactAdded(args);
+			sensorContactLog.Push(inBody1.GetID(), inBody2.GetID(), true);
 		}
 	}
 
 	virtual void OnContactPersisted(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold, ContactSettings& ioSettings) override
 	{
-		if (callbackContactPersisted)
-		{
-			auto bodyId1 = inBody1.GetID();
-			auto bodyId2 = inBody2.GetID();
-			auto userData1 = inBody1.GetUserData();
-			auto userData2 = inBody2.GetUserData();
-
-			EgJoltContactArgs args;
-			args.bodyId1 = *(unsigned int*)&bodyId1;
-			args.userData1 = userData1;
-			args.point1 = ConvertVector3(inManifold.GetWorldSpaceContactPointOn1(0));
-			args.bodyId2 = *(unsigned int*)&bodyId2;
-			args.userData2 = userData2;
-			args.point2 = ConvertVector3(inManifold.GetWorldSpaceContactPointOn2(0));
-
-			callbackContactPersisted(args);
-		}
+		contactCount.fetch_add(1, memory_order_relaxed);
+		contactQueue.Push(_egJoltCreateContactArgs(inBody1, inBody2, inManifold, EgJolt_ContactEvent_Persisted));
 	}
 
 	virtual void OnContactRemoved(const SubShapeIDPair& inSubShapePair) override
 	{
+		// The bodies cannot be accessed during this callback, so removed events only carry the body ids.
+		EgJoltContactArgs args = {};
+		args.bodyId1 = ConvertBodyId(inSubShapePair.GetBody1ID());
+		args.bodyId2 = ConvertBodyId(inSubShapePair.GetBody2ID());
+		args.contactEvent = EgJolt_ContactEvent_Removed;
+		contactQueue.Push(args);
+
+		// Whether one of the bodies is a sensor is not known here, so every removal is logged
+		sensorContactLog.Push(inSubShapePair.GetBody1ID(), inSubShapePair.GetBody2ID(), false);
 	}
 };
 
+/// Records activation changes in the order they happened, egJoltUpdate publishes them at the end of the step. Jolt calls this from its job threads while it holds body locks,
+/// and bodies only change activation state a few times per step, so a mutex around a growable array is enough.
 class MyBodyActivationListener : public BodyActivationListener
 {
 public:
 	virtual void OnBodyActivated(const BodyID& inBodyID, uint64 inBodyUserData) override
 	{
+		AddChange(inBodyID, inBodyUserData, true);
 	}
 
 	virtual void OnBodyDeactivated(const BodyID& inBodyID, uint64 inBodyUserData) override
 	{
+		AddChange(inBodyID, inBodyUserData, false);
+	}
+
+	// Hands out the changes recorded since the last call, keeping the memory of both arrays
+	void SwapChanges(Array<EgJoltActivationChange>& outChanges)
+	{
+		lock_guard<mutex> lock(changesMutex);
+		outChanges.swap(changes);
+		changes.clear();
+	}
+
+	void AddChange(const BodyID& bodyId, uint64 userData, bool isActive)
+	{
+		EgJoltActivationChange change;
+		change.bodyId = bodyId.GetIndexAndSequenceNumber();
+		change.userData = userData;
+		change.isActive = isActive;
+
+		lock_guard<mutex> lock(changesMutex);
+		changes.push_back(change);
 	}
+
+	mutex changesMutex;
+	Array<EgJoltActivationChange> changes;
 };
 
 class MyCharacterVirtualContactListener : public CharacterContactListener
@@ -260,321 +678,3015 @@ public:
 	}
 };
 
-inline EActivation GetActivation(BodyInterface& bodyInterface, BodyID bodyId)
+/// StateRecorder that reads and writes raw bytes in memory so saving and restoring is a plain memcpy.
+/// Writes go into a caller-supplied buffer when one is given, otherwise into a growable array that is reused between saves.
+class EgJoltMemoryStateRecorder final : public StateRecorder
 {
-	if (bodyInterface.IsActive(bodyId))
+public:
+	EgJoltMemoryStateRecorder(void* buffer, size_t capacity) : mBuffer((uint8*)buffer), mCapacity(capacity) {}
+	EgJoltMemoryStateRecorder(Array<uint8>* growable) : mGrowable(growable) {}
+
+	virtual void WriteBytes(const void* inData, size_t inNumBytes) override
 	{
-		return EActivation::Activate;
+		if (mGrowable)
+		{
+			mGrowable->insert(mGrowable->end(), (const uint8*)inData, (const uint8*)inData + inNumBytes);
+		}
+		else if (mSize + inNumBytes <= mCapacity)
+		{
+			memcpy(mBuffer + mSize, inData, inNumBytes);
+		}
+
+		// Keep counting past the end of a caller-supplied buffer so the required size can be reported.
+		mSize += inNumBytes;
 	}
-	return EActivation::DontActivate;
-}
 
-// ------------------------------------
+	virtual void ReadBytes(void* outData, size_t inNumBytes) override
+	{
+		const uint8* data = mGrowable ? mGrowable->data() : mBuffer;
+		size_t size = mGrowable ? mGrowable->size() : mCapacity;
 
-struct EgJoltInstanceInternal {
-	TempAllocatorImpl* temp_allocator;
-	JobSystemThreadPool* job_system;
-	BPLayerInterfaceImpl* broad_phase_layer_interface;
-	ObjectVsBroadPhaseLayerFilterImpl* object_vs_broadphase_layer_filter;
-	ObjectLayerPairFilterImpl* object_vs_object_layer_filter;
-	MyBodyActivationListener* body_activation_listener;
-	MyContactListener* contact_listener;
-	MyCharacterVirtualContactListener* characterContactListener;
-	MyBodyFilter* bodyFilter;
+		if (mReadOffset + inNumBytes > size)
+		{
+			mFailed = true;
+			memset(outData, 0, inNumBytes);
+			return;
+		}
 
-	PhysicsSystem* physics_system;
-};
+		memcpy(outData, data + mReadOffset, inNumBytes);
+		mReadOffset += inNumBytes;
+	}
 
-inline void _Jolt_Body_SetVelocity(Body* body, Vec3Arg linearVelocity, Vec3Arg angularVelocity)
-{
-	if (!body->IsStatic())
+	// Like std::istream this only reports the end after a read went past it, Shape::sRestoreWithChildren relies on that
+	virtual bool IsEOF() const override
 	{
-		body->SetLinearVelocityClamped(linearVelocity);
-		body->SetAngularVelocityClamped(angularVelocity);
+		return mFailed;
 	}
-}
-
-inline EgJoltInstanceInternal* GetInternalInstance(EgJoltInstance instance)
-{
-	return (EgJoltInstanceInternal*)instance.internal;
-}
-
-inline BodyInterface& _egJolt_GetBodyInterfaceNoLock(EgJoltInstance instance)
-{
-	return GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
-}
 
-inline const BodyLockInterfaceNoLock& _egJolt_GetBodyLockInterfaceNoLock(EgJoltInstance instance)
-{
-	return GetInternalInstance(instance)->physics_system->GetBodyLockInterfaceNoLock();
-}
+	virtual bool IsFailed() const override
+	{
+		return mFailed || (!mGrowable && mSize > mCapacity);
+	}
 
-static inline Body* _egJolt_GetBody(EgJoltInstance instance, unsigned int bodyId)
-{
-	const BodyLockInterfaceNoLock& bodyInterface = _egJolt_GetBodyLockInterfaceNoLock(instance);
-	Body*                          body          = bodyInterface.TryGetBody(ConvertBodyId(bodyId));
-	assert(body != nullptr);
-	return body;
-}
+	size_t GetSize() const
+	{
+		return mSize;
+	}
 
-inline bool _egJolt_Body_IsSensor(EgJoltInstance instance, unsigned int bodyId)
-{
-	return _egJolt_GetBody(instance, bodyId)->IsSensor();
-}
+private:
+	uint8* mBuffer = nullptr;
+	size_t mCapacity = 0;
+	Array<uint8>* mGrowable = nullptr;
+	size_t mSize = 0;
+	size_t mReadOffset = 0;
+	bool mFailed = false;
+};
 
-inline void _egJolt_Body_SetIsSensor(EgJoltInstance instance, unsigned int bodyId, bool isSensor)
+/// Only records bodies that are dynamic and awake, along with the contacts they take part in.
+class EgJoltActiveDynamicBodiesStateFilter final : public StateRecorderFilter
 {
-	_egJolt_GetBody(instance, bodyId)->SetIsSensor(isSensor);
-}
+public:
+	const BodyLockInterfaceNoLock* lockInterface;
 
-inline void _egJolt_Body_SetPositionAndRotation(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 position, EgJoltQuaternion rotation)
-{
-	_egJolt_GetBodyInterfaceNoLock(instance).SetPositionAndRotation(
-		ConvertBodyId(bodyId),
-		ConvertVector3(position),
-		ConvertQuaternion(rotation),
-		EActivation::DontActivate
-	);
-}
+	static bool IsActiveDynamic(const Body* body)
+	{
+		return body != nullptr && body->IsDynamic() && body->IsActive();
+	}
 
-inline void _egJolt_Body_SetIsActive(EgJoltInstance instance, unsigned int bodyId, bool isActive)
-{
-	if (isActive)
+	virtual bool ShouldSaveBody(const Body& inBody) const override
 	{
-		_egJolt_GetBodyInterfaceNoLock(instance).ActivateBody(ConvertBodyId(bodyId));
+		return IsActiveDynamic(&inBody);
 	}
-	else
+
+	virtual bool ShouldSaveContact(const BodyID& inBody1, const BodyID& inBody2) const override
 	{
-		_egJolt_GetBodyInterfaceNoLock(instance).DeactivateBody(ConvertBodyId(bodyId));
+		return IsActiveDynamic(lockInterface->TryGetBody(inBody1)) || IsActiveDynamic(lockInterface->TryGetBody(inBody2));
 	}
-}
+};
 
-inline unsigned int _egJoltAddBody(EgJoltInstance instance, EMotionType motionType, ObjectLayer layer, float mass, ShapeSettings::ShapeResult shapeResult, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state)
-{
+struct EgJoltStateFrame {
+	unsigned int frame;
+	bool isValid;
+	Array<uint8> data;
+};
+
+inline EActivation GetActivation(BodyInterface& bodyInterface, BodyID bodyId)
+{
+	if (bodyInterface.IsActive(bodyId))
+	{
+		return EActivation::Activate;
+	}
+	return EActivation::DontActivate;
+}
+
+/// Work-stealing job system that is shared by every instance in the process (and by game code through egJoltJobSystemParallelFor).
+/// Each worker owns a queue. It runs its own jobs newest first and steals the oldest jobs of the other workers when it runs dry.
+/// Jobs queued from outside the pool are spread round-robin over the workers; the queuing thread helps out while it waits on its barrier.
+class EgJoltJobSystemImpl final : public JobSystemWithBarrier
+{
+public:
+	JPH_OVERRIDE_NEW_DELETE
+
+	EgJoltJobSystemImpl(uint maxJobs, uint maxBarriers, int threadCount, uint64 affinityMask)
+	{
+		JobSystemWithBarrier::Init(maxBarriers);
+		jobs.Init(maxJobs, maxJobs);
+
+		if (threadCount < 0)
+			threadCount = max((int)thread::hardware_concurrency() - 1, 0);
+
+		queues = new WorkerQueue[threadCount];
+		threads.reserve(threadCount);
+		for (int i = 0; i < threadCount; i++)
+		{
+			threads.emplace_back([this, i, affinityMask] { ThreadMain(i, affinityMask); });
+		}
+	}
+
+	virtual ~EgJoltJobSystemImpl() override
+	{
+		quit = true;
+		if (!threads.empty())
+		{
+			semaphore.Release((uint)threads.size());
+		}
+		for (thread& t : threads)
+		{
+			t.join();
+		}
+
+		// Run anything that is still queued so no barrier is left waiting on it
+		for (size_t i = 0; i < threads.size(); i++)
+		{
+			while (Job* job = queues[i].PopFront())
+			{
+				job->Execute();
+				job->Release();
+			}
+		}
+		delete[] queues;
+	}
+
+	virtual int GetMaxConcurrency() const override
+	{
+		return int(threads.size()) + 1;
+	}
+
+	virtual JobHandle CreateJob(const char* inName, ColorArg inColor, const JobFunction& inJobFunction, uint32 inNumDependencies = 0) override
+	{
+		// Loop until we can get a job from the free list
+		uint32 index;
+		for (;;)
+		{
+			index = jobs.ConstructObject(inName, inColor, this, inJobFunction, inNumDependencies);
+			if (index != FixedSizeFreeList<Job>::cInvalidObjectIndex)
+				break;
+			JPH_ASSERT(false, "No jobs available!");
+			this_thread::sleep_for(chrono::microseconds(100));
+		}
+		Job* job = &jobs.Get(index);
+
+		// Keep a reference, the job is queued below and may immediately complete
+		JobHandle handle(job);
+		if (inNumDependencies == 0)
+		{
+			QueueJob(job);
+		}
+		return handle;
+	}
+
+protected:
+	virtual void QueueJob(Job* inJob) override
+	{
+		// Without workers the barrier runs the job when it is waited on
+		if (threads.empty())
+			return;
+
+		Push(inJob);
+		semaphore.Release();
+	}
+
+	virtual void QueueJobs(Job** inJobs, uint inNumJobs) override
+	{
+		JPH_ASSERT(inNumJobs > 0);
+
+		if (threads.empty())
+			return;
+
+		for (uint i = 0; i < inNumJobs; i++)
+		{
+			Push(inJobs[i]);
+		}
+		semaphore.Release(min(inNumJobs, (uint)threads.size()));
+	}
+
+	virtual void FreeJob(Job* inJob) override
+	{
+		jobs.DestructObject(inJob);
+	}
+
+private:
+	// Number of times an idle worker looks for work before going to sleep. Keeps workers awake between the
+	// back-to-back job batches of a physics step instead of putting them to sleep and waking them up again.
+	static constexpr int cSpinCount = 64;
+
+	struct alignas(JPH_CACHE_LINE_SIZE) WorkerQueue
+	{
+		mutex lock;
+		Array<Job*> jobs;
+		size_t head = 0;
+
+		void PushBack(Job* job)
+		{
+			lock_guard<mutex> guard(lock);
+			jobs.push_back(job);
+		}
+
+		Job* PopBack()
+		{
+			lock_guard<mutex> guard(lock);
+			if (head == jobs.size())
+				return nullptr;
+			Job* job = jobs.back();
+			jobs.pop_back();
+			if (head == jobs.size())
+			{
+				jobs.clear();
+				head = 0;
+			}
+			return job;
+		}
+
+		Job* PopFront()
+		{
+			lock_guard<mutex> guard(lock);
+			if (head == jobs.size())
+				return nullptr;
+			Job* job = jobs[head++];
+			if (head == jobs.size())
+			{
+				jobs.clear();
+				head = 0;
+			}
+			return job;
+		}
+	};
+
+	inline static thread_local EgJoltJobSystemImpl* currentJobSystem = nullptr;
+	inline static thread_local int currentWorkerIndex = -1;
+
+	void Push(Job* job)
+	{
+		// Add reference to job because we're adding the job to a queue
+		job->AddRef();
+
+		// Workers keep the jobs they spawn, everyone else spreads them over the workers
+		size_t index;
+		if (currentJobSystem == this)
+		{
+			index = (size_t)currentWorkerIndex;
+		}
+		else
+		{
+			index = nextQueue.fetch_add(1, memory_order_relaxed) % threads.size();
+		}
+		queues[index].PushBack(job);
+	}
+
+	Job* TryPop(int workerIndex)
+	{
+		if (Job* job = queues[workerIndex].PopBack())
+			return job;
+
+		size_t count = threads.size();
+		for (size_t i = 1; i < count; i++)
+		{
+			if (Job* job = queues[(workerIndex + i) % count].PopFront())
+				return job;
+		}
+		return nullptr;
+	}
+
+	static void SetThreadAffinity(uint64 affinityMask, int workerIndex)
+	{
+		// Worker N runs on the N-th core in the mask, wrapping around when there are more workers than cores
+		uint coreCount = CountBits(affinityMask);
+		uint target = (uint)workerIndex % coreCount;
+		uint core = 0;
+		for (uint64 mask = affinityMask; ; mask &= mask - 1)
+		{
+			core = CountTrailingZeros(mask);
+			if (target-- == 0)
+				break;
+		}
+
+#if defined(JPH_PLATFORM_WINDOWS)
+		SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core);
+#elif defined(JPH_PLATFORM_LINUX)
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		CPU_SET(core, &cpuSet);
+		pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#endif
+	}
+
+	void ThreadMain(int workerIndex, uint64 affinityMask)
+	{
+		if (affinityMask != 0)
+		{
+			SetThreadAffinity(affinityMask, workerIndex);
+		}
+
+		FPExceptionsEnable enable_exceptions;
+		JPH_UNUSED(enable_exceptions);
+
+		currentJobSystem = this;
+		currentWorkerIndex = workerIndex;
+
+		int spin = 0;
+		while (!quit)
+		{
+			Job* job = TryPop(workerIndex);
+			if (job != nullptr)
+			{
+				job->Execute();
+				job->Release();
+				spin = 0;
+			}
+			else if (spin < cSpinCount)
+			{
+				spin++;
+				this_thread::yield();
+			}
+			else
+			{
+				semaphore.Acquire();
+				spin = 0;
+			}
+		}
+	}
+
+	FixedSizeFreeList<Job> jobs;
+	Array<thread> threads;
+	WorkerQueue* queues = nullptr;
+	atomic<size_t> nextQueue = 0;
+	Semaphore semaphore;
+	atomic<bool> quit = false;
+};
+
+inline EgJoltJobSystemImpl* GetInternalJobSystem(EgJoltJobSystem jobSystem)
+{
+	return (EgJoltJobSystemImpl*)jobSystem.internal;
+}
+
+static EgJoltJobSystemImpl* s_defaultJobSystem = nullptr;
+
+/// Number of instances the shared job system has job and barrier room for when they all step at once.
+static constexpr unsigned int cDefaultJobSystemMaxInstances = 4;
+
+/// Runs func(jobIndex, start, end) over ranges of at most batchSize items on the job system and waits for all of them.
+/// One job per thread pulls batches until none are left, so uneven batches still balance out. jobIndex is below the job system's max concurrency.
+template<typename F>
+inline void _egJoltParallelForJobs(JobSystem* jobSystem, unsigned int count, unsigned int batchSize, const F& func)
+{
+	if (count == 0)
+		return;
+
+	batchSize = max(batchSize, 1u);
+	unsigned int batchCount = (count + batchSize - 1) / batchSize;
+	unsigned int jobCount = min(batchCount, (unsigned int)jobSystem->GetMaxConcurrency());
+	if (jobCount <= 1)
+	{
+		func(0u, 0u, count);
+		return;
+	}
+
+	atomic<unsigned int> nextBatch = 0;
+	JobSystem::Barrier* barrier = jobSystem->CreateBarrier();
+	if (barrier == nullptr)
+	{
+		// Every barrier is taken by other instances stepping on the same job system, run on the calling thread instead.
+		func(0u, 0u, count);
+		return;
+	}
+
+	for (unsigned int i = 0; i < jobCount; i++)
+	{
+		auto runBatches = [&nextBatch, &func, i, batchCount, batchSize, count]()
+		{
+			for (unsigned int batch = nextBatch.fetch_add(1); batch < batchCount; batch = nextBatch.fetch_add(1))
+			{
+				unsigned int start = batch * batchSize;
+				func(i, start, min(start + batchSize, count));
+			}
+		};
+		barrier->AddJob(jobSystem->CreateJob("egJoltParallelFor", Color::sGreen, runBatches));
+	}
+	jobSystem->WaitForJobs(barrier);
+	jobSystem->DestroyBarrier(barrier);
+}
+
+/// Runs func(start, end) over ranges of at most batchSize items on the job system and waits for all of them.
+template<typename F>
+inline void _egJoltParallelFor(JobSystem* jobSystem, unsigned int count, unsigned int batchSize, const F& func)
+{
+	_egJoltParallelForJobs(jobSystem, count, batchSize, [&func](unsigned int, unsigned int start, unsigned int end)
+	{
+		func(start, end);
+	});
+}
+
+// ------------------------------------
+
+/// Temp allocator that remembers the most memory that was in use at once since the last reset.
+/// Allocations that do not fit in the main arena go to an overflow arena instead of failing, and the next step starts with a main arena that fits them.
+class EgJoltTempAllocator final : public TempAllocator
+{
+public:
+	JPH_OVERRIDE_NEW_DELETE
+
+	explicit EgJoltTempAllocator(uint size) : allocator(new TempAllocatorImpl(size)) {}
+
+	~EgJoltTempAllocator()
+	{
+		delete allocator;
+		delete overflowAllocator;
+	}
+
+	virtual void* Allocate(uint inSize) override
+	{
+		void* address;
+		if (allocator->CanAllocate(inSize))
+		{
+			address = allocator->Allocate(inSize);
+		}
+		else
+		{
+			if (!overflowAllocator)
+			{
+				overflowAllocator = new TempAllocatorImplWithMallocFallback((uint)allocator->GetSize());
+			}
+			address = overflowAllocator->Allocate(inSize);
+			overflowUsage += AlignUp(inSize, JPH_RVECTOR_ALIGNMENT);
+			overflowCount++;
+		}
+
+		size_t usage = allocator->GetUsage() + overflowUsage;
+		highWaterMark = max(highWaterMark, usage);
+		peakUsage = max(peakUsage, usage);
+		return address;
+	}
+
+	virtual void Free(void* inAddress, uint inSize) override
+	{
+		// Frees come in reverse order of allocation, so each arena still sees its own allocations freed in reverse order
+		if (!overflowAllocator || allocator->OwnsMemory(inAddress) || inAddress == nullptr)
+		{
+			allocator->Free(inAddress, inSize);
+		}
+		else
+		{
+			overflowAllocator->Free(inAddress, inSize);
+			overflowUsage -= AlignUp(inSize, JPH_RVECTOR_ALIGNMENT);
+		}
+	}
+
+	/// Replaces the arenas with one main arena that fits the high-water mark, only when nothing is allocated and the last step overflowed.
+	void GrowToHighWaterMark()
+	{
+		if (!overflowAllocator || !allocator->IsEmpty() || overflowUsage != 0)
+			return;
+
+		size_t size = AlignUp(highWaterMark, cGrowGranularity);
+		delete overflowAllocator;
+		overflowAllocator = nullptr;
+		delete allocator;
+		allocator = new TempAllocatorImpl(size);
+	}
+
+	void ResetHighWaterMark()
+	{
+		highWaterMark = allocator->GetUsage() + overflowUsage;
+	}
+
+	size_t GetHighWaterMark() const
+	{
+		return highWaterMark;
+	}
+
+	size_t GetSize() const
+	{
+		return allocator->GetSize();
+	}
+
+	size_t GetPeakUsage() const
+	{
+		return peakUsage;
+	}
+
+	uint64 GetOverflowCount() const
+	{
+		return overflowCount;
+	}
+
+private:
+	static constexpr size_t cGrowGranularity = 1024 * 1024;
+
+	TempAllocatorImpl* allocator;
+	TempAllocatorImplWithMallocFallback* overflowAllocator = nullptr;
+	size_t overflowUsage = 0;
+	size_t highWaterMark = 0;
+	size_t peakUsage = 0;
+	uint64 overflowCount = 0;
+};
+
+/// One side of the double-buffered transform snapshot
+struct EgJoltSnapshotBuffer {
+	unsigned int frame = 0;
+	Array<unsigned int> bodyIds;
+	Array<EgJoltVector3> positions;
+	Array<EgJoltQuaternion> rotations;
+};
+
+/// A body overlapping a sensor. Kept until the last of their sub-shape contacts is removed.
+struct EgJoltSensorOverlap {
+	unsigned int contactCount;
+	unsigned int sensorBodyId;
+	unsigned int otherBodyId;
+	unsigned long long sensorUserData;
+	unsigned long long otherUserData;
+	unsigned char otherLayer;
+};
+
+/// Pose of a lag compensated body at a recorded tick. The transformed shape keeps the shape alive after the body is gone.
+struct EgJoltHistoricalBody {
+	TransformedShape transformedShape;
+	AABox bounds;
+	unsigned long long userData;
+	unsigned char layer;
+};
+
+/// Bounding volume hierarchy node over the bodies of a recorded tick. Leaves hold bodyCount bodies starting at firstBody,
+/// inner nodes have their left child right after them and their right child at rightChild.
+struct EgJoltHistoryNode {
+	AABox bounds;
+	unsigned int firstBody;
+	unsigned int bodyCount;
+	unsigned int rightChild;
+};
+
+struct EgJoltHistoryTick {
+	unsigned int tick;
+	bool isValid;
+	Array<EgJoltHistoricalBody> bodies;
+	Array<EgJoltHistoryNode> nodes;
+};
+
+/// A body owned by a body pool. Parked bodies are kept out of the broadphase but are not destroyed.
+struct EgJoltPooledBody {
+	BodyID bodyId;
+	bool isAcquired;
+	bool isActive;		// Activation to use when the body enters the broadphase
+	bool isDirty;		// Listed in dirtySlots until the next flush
+};
+
+struct EgJoltBodyPoolInternal {
+	Array<EgJoltPooledBody> bodies;
+	UnorderedMap<uint32, uint32> slots;		// Body id -> index into bodies
+	Array<uint32> freeSlots;
+	Array<uint32> dirtySlots;				// Acquired or released since the last flush
+};
+
+struct EgJoltInstanceInternal {
+	EgJoltTempAllocator* temp_allocator;
+	JobSystem* job_system;
+	EgJoltJobSystemImpl* ownedJobSystem;
+	int collisionSteps;
+	BPLayerInterfaceImpl* broad_phase_layer_interface;
+	ObjectVsBroadPhaseLayerFilterImpl* object_vs_broadphase_layer_filter;
+	ObjectLayerPairFilterImpl* object_vs_object_layer_filter;
+	MyBodyActivationListener* body_activation_listener;
+	MyContactListener* contact_listener;
+	void(*callbackContactAdded)(EgJoltContactArgs);
+	void(*callbackContactPersisted)(EgJoltContactArgs);
+	MyCharacterVirtualContactListener* characterContactListener;
+	MyBodyFilter* bodyFilter;
+
+	PhysicsSystem* physics_system;
+
+	EgJoltLayerMatrix layerMatrix;
+	UnorderedSet<uint64> contactPairs;
+	Array<uint64> contactPairsScratch;
+	UnorderedMap<uint64, EgJoltSensorOverlap> sensorOverlaps;
+	unsigned int sleepingSensorOverlapCount = 0;
+	Array<EgJoltTriggerArgs> triggerEvents;
+	Array<EgJoltActivationChange> activationChanges;
+	Array<unsigned int> changedBodies;
+	Array<BodyID> stateHashBodies;
+	Array<uint64> stateHashScratch;
+	Array<CharacterVirtual*> characterVirtuals;
+	Array<TempAllocator*> characterTempAllocators;
+	float maxCharacterPredictiveContactDistance = 0;
+	Array<EgJoltStateFrame> stateHistory;
+	Array<BodyID> lagCompensatedBodies;
+	Array<EgJoltHistoryTick> lagCompensationHistory;
+	Array<EgJoltBodyPoolInternal*> bodyPools;
+	Array<BodyID> pooledBodiesToAdd[2];		// Inactive and active bodies, activation is given per batch
+	Array<BodyID> pooledBodiesToRemove;
+
+	JobHandle updateJob;
+	JobSystem::Barrier* updateBarrier = nullptr;
+	EgJoltUpdateStats updateStats = {};
+	uint64 allHeapAllocationsDuringStep = 0;
+	EgJoltSnapshotBuffer snapshots[2];
+	atomic<unsigned int> snapshotIndex = 0;
+	Array<BodyID> snapshotBodies;		///< Sorted ids of the non-static bodies, rebuilt only after bodies were created
+	bool snapshotBodiesChanged = true;
+};
+
+inline void _Jolt_Body_SetVelocity(Body* body, Vec3Arg linearVelocity, Vec3Arg angularVelocity)
+{
+	if (!body->IsStatic())
+	{
+		body->SetLinearVelocityClamped(linearVelocity);
+		body->SetAngularVelocityClamped(angularVelocity);
+	}
+}
+
+inline EgJoltInstanceInternal* GetInternalInstance(EgJoltInstance instance)
+{
+	return (EgJoltInstanceInternal*)instance.internal;
+}
+
+inline BodyInterface& _egJolt_GetBodyInterfaceNoLock(EgJoltInstance instance)
+{
+	return GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
+}
+
+inline const BodyLockInterfaceNoLock& _egJolt_GetBodyLockInterfaceNoLock(EgJoltInstance instance)
+{
+	return GetInternalInstance(instance)->physics_system->GetBodyLockInterfaceNoLock();
+}
+
+static inline Body* _egJolt_GetBody(EgJoltInstance instance, unsigned int bodyId)
+{
+	const BodyLockInterfaceNoLock& bodyInterface = _egJolt_GetBodyLockInterfaceNoLock(instance);
+	Body*                          body          = bodyInterface.TryGetBody(ConvertBodyId(bodyId));
+	assert(body != nullptr);
+	return body;
+}
+
+inline EgJolt_BodyFlags _egJolt_Body_GetFlags(const Body* body)
+{
+	EgJolt_BodyFlags flags = EgJolt_BodyFlags_None;
+
+	if (body->IsSensor())
+	{
+		flags = flags | EgJolt_BodyFlags_IsSensor;
+	}
+
+	if (body->IsActive())
+	{
+		flags = flags | EgJolt_BodyFlags_IsActive;
+	}
+
+	return flags;
+}
+
+inline bool _egJolt_Body_IsSensor(EgJoltInstance instance, unsigned int bodyId)
+{
+	return _egJolt_GetBody(instance, bodyId)->IsSensor();
+}
+
+inline void _egJolt_Body_SetIsSensor(EgJoltInstance instance, unsigned int bodyId, bool isSensor)
+{
+	_egJolt_GetBody(instance, bodyId)->SetIsSensor(isSensor);
+}
+
+inline void _egJolt_Body_SetPositionAndRotation(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 position, EgJoltQuaternion rotation)
+{
+	_egJolt_GetBodyInterfaceNoLock(instance).SetPositionAndRotation(
+		ConvertBodyId(bodyId),
+		ConvertRVec3(position),
+		ConvertQuaternion(rotation),
+		EActivation::DontActivate
+	);
+}
+
+inline void _egJolt_Body_SetIsActive(EgJoltInstance instance, unsigned int bodyId, bool isActive)
+{
+	if (isActive)
+	{
+		_egJolt_GetBodyInterfaceNoLock(instance).ActivateBody(ConvertBodyId(bodyId));
+	}
+	else
+	{
+		_egJolt_GetBodyInterfaceNoLock(instance).DeactivateBody(ConvertBodyId(bodyId));
+	}
+}
+
+inline EgJoltBodyCreationOptions _egJoltGetDefaultBodyCreationOptions()
+{
+	BodyCreationSettings bodySettings;
+
+	EgJoltBodyCreationOptions options = {};
+	options.motionQuality = EgJolt_MotionQuality_LinearCast;
+	options.enhancedInternalEdgeRemoval = true;
+	options.allowedDOFs = (EgJolt_AllowedDOFs)bodySettings.mAllowedDOFs;
+	options.friction = bodySettings.mFriction;
+	options.restitution = bodySettings.mRestitution;
+	options.linearDamping = bodySettings.mLinearDamping;
+	options.angularDamping = bodySettings.mAngularDamping;
+	options.maxLinearVelocity = bodySettings.mMaxLinearVelocity;
+	options.maxAngularVelocity = bodySettings.mMaxAngularVelocity;
+	return options;
+}
+
+// Null options give every moving body continuous collision detection and enhanced internal edge removal, which is what bodies got before options existed.
+// Static bodies never move, so they get discrete motion quality instead.
+inline BodyCreationSettings _egJoltCreateBodySettings(EMotionType motionType, ObjectLayer layer, float mass, const Shape* shape, const EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
+{
+	EgJoltBodyCreationOptions defaultOptions;
+	if (!options)
+	{
+		defaultOptions = _egJoltGetDefaultBodyCreationOptions();
+		if (motionType == EMotionType::Static)
+		{
+			defaultOptions.motionQuality = EgJolt_MotionQuality_Discrete;
+		}
+		options = &defaultOptions;
+	}
+
+	// Create the settings for the body itself. Note that here you can also set other properties like the restitution / friction.
+	BodyCreationSettings bodySettings(shape, ConvertRVec3(state->position), *(Quat*)&state->rotation, motionType, layer);
+	auto massProps = bodySettings.GetMassProperties();
+	massProps.mMass = mass;
+	bodySettings.mMassPropertiesOverride = massProps;
+	bodySettings.mMotionQuality = options->motionQuality == EgJolt_MotionQuality_LinearCast ? EMotionQuality::LinearCast : EMotionQuality::Discrete;
+	bodySettings.mOverrideMassProperties = EOverrideMassProperties::CalculateInertia;
+	bodySettings.mIsSensor = state->flags & EgJolt_BodyFlags_IsSensor;
+	bodySettings.mLinearVelocity = ConvertVector3(state->linearVelocity);
+	bodySettings.mAngularVelocity = ConvertVector3(state->angularVelocity);
+	bodySettings.mAllowSleeping = true;
+	bodySettings.mGravityFactor = state->gravityFactor;
+	bodySettings.mEnhancedInternalEdgeRemoval = options->enhancedInternalEdgeRemoval;
+	bodySettings.mAllowedDOFs = options->allowedDOFs != 0 ? (EAllowedDOFs)options->allowedDOFs : EAllowedDOFs::All;
+	bodySettings.mFriction = options->friction;
+	bodySettings.mRestitution = options->restitution;
+	bodySettings.mLinearDamping = options->linearDamping;
+	bodySettings.mAngularDamping = options->angularDamping;
+	// 0 keeps Jolt's limits, like allowedDOFs, so options that were only zeroed do not freeze the body
+	if (options->maxLinearVelocity > 0)
+	{
+		bodySettings.mMaxLinearVelocity = options->maxLinearVelocity;
+	}
+	if (options->maxAngularVelocity > 0)
+	{
+		bodySettings.mMaxAngularVelocity = options->maxAngularVelocity;
+	}
+
+	return bodySettings;
+}
+
+inline unsigned int _egJoltAddBody(EgJoltInstance instance, EMotionType motionType, ObjectLayer layer, float mass, const Shape* shape, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options = nullptr)
+{
+	BodyInterface& bodyInterface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
+
+	EActivation activation = {};
+	if (state->flags & EgJolt_BodyFlags_IsActive)
+	{
+		activation = EActivation::Activate;
+	}
+	else
+	{
+		activation = EActivation::DontActivate;
+	}
+
+	// The shape failed to build
+	if (shape == nullptr)
+		return BodyID::cInvalidBodyID;
+
+	BodyCreationSettings bodySettings = _egJoltCreateBodySettings(motionType, layer, mass, shape, state, options);
+	bodySettings.mUserData = userData; // Set before adding so the activation listener sees it
+
+	Body* body; // Note that if we run out of bodies this can return nullptr
+	if (bodyId)
+	{
+		body = bodyInterface.CreateBodyWithID(*bodyId, bodySettings);
+	}
+	else
+	{
+		body = bodyInterface.CreateBody(bodySettings);
+	}
+	if (body == nullptr)
+		return BodyID::cInvalidBodyID;
+
+	// Add it to the world
+	bodyInterface.AddBody(body->GetID(), activation);
+	GetInternalInstance(instance)->snapshotBodiesChanged = true;
+
+	return *(unsigned int*)(&body->GetID());
+}
+
+inline unsigned int _egJoltAddBody2(EgJoltInstance instance, EMotionType motionType, ObjectLayer layer, float mass, Shape* shape, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
+{
 	BodyInterface& bodyInterface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
-	ShapeRefC shape = shapeResult.Get(); // We don't expect an error here, but you can check floor_shape_result for HasError() / GetError()
 
-	EActivation activation = {};
-	if (state->flags & EgJolt_BodyFlags_IsActive)
+	EActivation activation = {};
+	if (state->flags & EgJolt_BodyFlags_IsActive)
+	{
+		activation = EActivation::Activate;
+	}
+	else
+	{
+		activation = EActivation::DontActivate;
+	}
+
+	BodyCreationSettings bodySettings = _egJoltCreateBodySettings(motionType, layer, mass, shape, state, options);
+	bodySettings.mUserData = userData; // Set before adding so the activation listener sees it
+
+	Body* body; // Note that if we run out of bodies this can return nullptr
+	if (bodyId)
+	{
+		body = bodyInterface.CreateBodyWithID(*bodyId, bodySettings);
+	}
+	else
+	{
+		body = bodyInterface.CreateBody(bodySettings);
+	}
+	if (body == nullptr)
+		return false;
+
+	// Add it to the world
+	bodyInterface.AddBody(body->GetID(), activation);
+	GetInternalInstance(instance)->snapshotBodiesChanged = true;
+
+	return true;
+}
+
+// Reorders the ids, AddBodiesPrepare sorts them.
+inline unsigned int _egJoltAddBodyBatches(PhysicsSystem* physicsSystem, Array<BodyID>& activeBodyIds, Array<BodyID>& inactiveBodyIds)
+{
+	BodyInterface& bodyInterface = physicsSystem->GetBodyInterfaceNoLock();
+
+	// Each batch is built into its own broadphase tree and then linked into the world in one go
+	if (!activeBodyIds.empty())
+	{
+		BodyInterface::AddState addState = bodyInterface.AddBodiesPrepare(activeBodyIds.data(), (int)activeBodyIds.size());
+		bodyInterface.AddBodiesFinalize(activeBodyIds.data(), (int)activeBodyIds.size(), addState, EActivation::Activate);
+	}
+	if (!inactiveBodyIds.empty())
+	{
+		BodyInterface::AddState addState = bodyInterface.AddBodiesPrepare(inactiveBodyIds.data(), (int)inactiveBodyIds.size());
+		bodyInterface.AddBodiesFinalize(inactiveBodyIds.data(), (int)inactiveBodyIds.size(), addState, EActivation::DontActivate);
+	}
+
+	unsigned int createdCount = (unsigned int)(activeBodyIds.size() + inactiveBodyIds.size());
+	if (createdCount > 0)
+	{
+		physicsSystem->OptimizeBroadPhase();
+	}
+	return createdCount;
+}
+
+inline unsigned int _egJoltAddBodies(EgJoltInstance instance, EMotionType motionType, const EgJoltShape* shapes, const float* masses, const unsigned long long* userData, const EgJoltBodyState* states, const EgJoltBodyCreationOptions* options, unsigned int count, unsigned int* bodyIds)
+{
+	auto physicsSystem = GetInternalInstance(instance)->physics_system;
+	BodyInterface& bodyInterface = physicsSystem->GetBodyInterfaceNoLock();
+
+	// The activation is given per batch, so active and inactive bodies are added as two batches
+	Array<BodyID> activeBodyIds;
+	Array<BodyID> inactiveBodyIds;
+
+	// Bodies with a requested id are created first, so bodies without one cannot take an id that comes later in the batch
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool isRequestedIdPass = pass == 0;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			if ((bodyIds[i] != BodyID::cInvalidBodyID) != isRequestedIdPass)
+				continue;
+
+			const EgJoltBodyState* state = &states[i];
+			BodyCreationSettings bodySettings = _egJoltCreateBodySettings(motionType, state->layer, masses ? masses[i] : 0, (const Shape*)shapes[i].internal, state, options ? &options[i] : nullptr);
+			bodySettings.mUserData = userData ? userData[i] : 0;
+
+			// Note that if we run out of bodies or the requested id is taken this returns nullptr
+			Body* body = isRequestedIdPass ? bodyInterface.CreateBodyWithID(ConvertBodyId(bodyIds[i]), bodySettings) : bodyInterface.CreateBody(bodySettings);
+			if (!body)
+			{
+				bodyIds[i] = BodyID::cInvalidBodyID;
+				continue;
+			}
+
+			bodyIds[i] = ConvertBodyId(body->GetID());
+			if (state->flags & EgJolt_BodyFlags_IsActive)
+			{
+				activeBodyIds.push_back(body->GetID());
+			}
+			else
+			{
+				inactiveBodyIds.push_back(body->GetID());
+			}
+		}
+	}
+
+	GetInternalInstance(instance)->snapshotBodiesChanged = true;
+	return _egJoltAddBodyBatches(physicsSystem, activeBodyIds, inactiveBodyIds);
+}
+
+/* BODY POOLS */
+// ------------------------------------
+
+inline EgJoltBodyPoolInternal* GetInternalBodyPool(EgJoltBodyPool pool)
+{
+	return (EgJoltBodyPoolInternal*)pool.internal;
+}
+
+inline EgJoltBodyPool _egJoltCreateBodyPool(EgJoltInstanceInternal* internalInstance, const Shape* shape, float mass, const EgJoltBodyCreationOptions* options, unsigned int count)
+{
+	BodyInterface& bodyInterface = internalInstance->physics_system->GetBodyInterfaceNoLock();
+
+	EgJoltBodyState state = {};
+	state.rotation.w = 1;
+	state.gravityFactor = 1;
+	BodyCreationSettings bodySettings = _egJoltCreateBodySettings(EMotionType::Dynamic, 0, mass, shape, &state, options);
+
+	auto pool = new EgJoltBodyPoolInternal();
+	pool->bodies.reserve(count);
+	pool->freeSlots.reserve(count);
+	pool->dirtySlots.reserve(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		Body* body = bodyInterface.CreateBody(bodySettings); // Note that if we run out of bodies this can return nullptr
+		if (!body)
+			break;
+
+		uint32 slot = (uint32)pool->bodies.size();
+		pool->bodies.push_back({ body->GetID(), false, false, false });
+		pool->slots.insert({ body->GetID().GetIndexAndSequenceNumber(), slot });
+	}
+
+	// Hand out the lowest slots first
+	for (uint32 slot = (uint32)pool->bodies.size(); slot > 0; slot--)
+	{
+		pool->freeSlots.push_back(slot - 1);
+	}
+
+	internalInstance->bodyPools.push_back(pool);
+	internalInstance->snapshotBodiesChanged = true;
+
+	EgJoltBodyPool outPool = {};
+	outPool.internal = pool;
+	return outPool;
+}
+
+inline void _egJoltMarkPooledBodyDirty(EgJoltBodyPoolInternal* pool, uint32 slot)
+{
+	EgJoltPooledBody& pooledBody = pool->bodies[slot];
+	if (!pooledBody.isDirty)
+	{
+		pooledBody.isDirty = true;
+		pool->dirtySlots.push_back(slot);
+	}
+}
+
+// Forgets a pooled body that was destroyed behind the pool's back, e.g. with egJoltRemoveBody. The slot is never handed out again.
+inline void _egJoltDropPooledBody(EgJoltBodyPoolInternal* pool, uint32 slot)
+{
+	EgJoltPooledBody& pooledBody = pool->bodies[slot];
+	pool->slots.erase(pooledBody.bodyId.GetIndexAndSequenceNumber());
+	pooledBody.bodyId = BodyID();
+	pooledBody.isAcquired = false;
+
+	auto it = std::find(pool->freeSlots.begin(), pool->freeSlots.end(), slot);
+	if (it != pool->freeSlots.end())
+	{
+		pool->freeSlots.erase(it);
+	}
+}
+
+inline unsigned int _egJoltAcquirePooledBody(EgJoltInstanceInternal* internalInstance, EgJoltBodyPoolInternal* pool, unsigned long long userData, const EgJoltBodyState* state)
+{
+	auto& lockInterface = internalInstance->physics_system->GetBodyLockInterfaceNoLock();
+
+	Body* body = nullptr;
+	uint32 slot = 0;
+	while (!body)
+	{
+		if (pool->freeSlots.empty())
+			return BodyID::cInvalidBodyID;
+
+		slot = pool->freeSlots.back();
+		body = lockInterface.TryGetBody(pool->bodies[slot].bodyId);
+		if (!body)
+		{
+			_egJoltDropPooledBody(pool, slot);
+		}
+	}
+	pool->freeSlots.pop_back();
+
+	EgJoltPooledBody& pooledBody = pool->bodies[slot];
+	pooledBody.isAcquired = true;
+	pooledBody.isActive = state->flags & EgJolt_BodyFlags_IsActive;
+
+	// None of these touch the broadphase while the body is parked
+	BodyInterface& bodyInterface = internalInstance->physics_system->GetBodyInterfaceNoLock();
+	body->SetUserData(userData);
+	body->SetIsSensor(state->flags & EgJolt_BodyFlags_IsSensor);
+	body->GetMotionProperties()->SetGravityFactor(state->gravityFactor);
+	bodyInterface.SetPositionAndRotation(pooledBody.bodyId, ConvertRVec3(state->position), *(Quat*)&state->rotation, EActivation::DontActivate);
+	bodyInterface.SetObjectLayer(pooledBody.bodyId, state->layer);
+	_Jolt_Body_SetVelocity(body, ConvertVector3(state->linearVelocity), ConvertVector3(state->angularVelocity));
+
+	if (body->IsInBroadPhase())
+	{
+		// Released and acquired again before the flush, so it never left the world
+		if (pooledBody.isActive)
+		{
+			bodyInterface.ActivateBody(pooledBody.bodyId);
+		}
+		else
+		{
+			bodyInterface.DeactivateBody(pooledBody.bodyId);
+		}
+	}
+	else
+	{
+		_egJoltMarkPooledBodyDirty(pool, slot);
+	}
+
+	return ConvertBodyId(pooledBody.bodyId);
+}
+
+inline bool _egJoltReleasePooledBody(EgJoltBodyPoolInternal* pool, unsigned int bodyId)
+{
+	auto it = pool->slots.find(bodyId);
+	if (it == pool->slots.end())
+		return false;
+
+	uint32 slot = it->second;
+	EgJoltPooledBody& pooledBody = pool->bodies[slot];
+	if (!pooledBody.isAcquired)
+		return false;
+
+	pooledBody.isAcquired = false;
+	pool->freeSlots.push_back(slot);
+	_egJoltMarkPooledBodyDirty(pool, slot);
+	return true;
+}
+
+// Moves the bodies acquired since the last flush into the broadphase and the released ones out of it, as one batch each,
+// so a busy frame costs a few broadphase updates instead of one per spawned or despawned body.
+inline void _egJoltFlushBodyPools(EgJoltInstanceInternal* internalInstance)
+{
+	auto& lockInterface = internalInstance->physics_system->GetBodyLockInterfaceNoLock();
+	auto& toAdd = internalInstance->pooledBodiesToAdd;
+	auto& toRemove = internalInstance->pooledBodiesToRemove;
+
+	for (EgJoltBodyPoolInternal* pool : internalInstance->bodyPools)
+	{
+		for (uint32 slot : pool->dirtySlots)
+		{
+			EgJoltPooledBody& pooledBody = pool->bodies[slot];
+			pooledBody.isDirty = false;
+
+			const Body* body = lockInterface.TryGetBody(pooledBody.bodyId);
+			if (!body)
+			{
+				_egJoltDropPooledBody(pool, slot);
+				continue;
+			}
+
+			// Bodies that were acquired and released again, or the other way round, can stay where they are
+			if (body->IsInBroadPhase() == pooledBody.isAcquired)
+				continue;
+
+			if (pooledBody.isAcquired)
+			{
+				toAdd[pooledBody.isActive].push_back(pooledBody.bodyId);
+			}
+			else
+			{
+				toRemove.push_back(pooledBody.bodyId);
+			}
+		}
+		pool->dirtySlots.clear();
+	}
+
+	BodyInterface& bodyInterface = internalInstance->physics_system->GetBodyInterfaceNoLock();
+	if (!toRemove.empty())
+	{
+		bodyInterface.RemoveBodies(toRemove.data(), (int)toRemove.size());
+		toRemove.clear();
+	}
+	for (unsigned int isActive = 0; isActive < 2; isActive++)
+	{
+		if (toAdd[isActive].empty())
+			continue;
+
+		BodyInterface::AddState addState = bodyInterface.AddBodiesPrepare(toAdd[isActive].data(), (int)toAdd[isActive].size());
+		bodyInterface.AddBodiesFinalize(toAdd[isActive].data(), (int)toAdd[isActive].size(), addState, isActive ? EActivation::Activate : EActivation::DontActivate);
+		toAdd[isActive].clear();
+	}
+}
+
+inline void _egJoltDestroyBodyPool(EgJoltInstanceInternal* internalInstance, EgJoltBodyPoolInternal* pool)
+{
+	// Pools of another instance, or ones that were already destroyed, are left alone
+	auto& bodyPools = internalInstance->bodyPools;
+	auto it = std::find(bodyPools.begin(), bodyPools.end(), pool);
+	if (it == bodyPools.end())
+		return;
+
+	BodyInterface& bodyInterface = internalInstance->physics_system->GetBodyInterfaceNoLock();
+	auto& lockInterface = internalInstance->physics_system->GetBodyLockInterfaceNoLock();
+
+	Array<BodyID> bodyIds;
+	Array<BodyID> addedBodyIds;
+	bodyIds.reserve(pool->bodies.size());
+	for (const EgJoltPooledBody& pooledBody : pool->bodies)
+	{
+		// Bodies destroyed behind the pool's back are skipped
+		const Body* body = lockInterface.TryGetBody(pooledBody.bodyId);
+		if (!body)
+			continue;
+
+		bodyIds.push_back(pooledBody.bodyId);
+		if (body->IsInBroadPhase())
+		{
+			addedBodyIds.push_back(pooledBody.bodyId);
+		}
+	}
+
+	if (!addedBodyIds.empty())
+	{
+		bodyInterface.RemoveBodies(addedBodyIds.data(), (int)addedBodyIds.size());
+	}
+	if (!bodyIds.empty())
+	{
+		bodyInterface.DestroyBodies(bodyIds.data(), (int)bodyIds.size());
+	}
+
+	bodyPools.erase(it);
+	delete pool;
+}
+
+/* SHAPE REGISTRY */
+
+enum class EgJoltShapeType : uint32
+{
+	Box,
+	Sphere,
+	Capsule,
+};
+
+/// Identifies a parametric shape by the parameters it was built from, so equal keys always mean equal geometry.
+struct EgJoltShapeKey
+{
+	EgJoltShapeType type;
+	float params[4];
+
+	bool operator==(const EgJoltShapeKey& other) const
+	{
+		return type == other.type &&
+			params[0] == other.params[0] && params[1] == other.params[1] && params[2] == other.params[2] && params[3] == other.params[3];
+	}
+};
+
+JPH_MAKE_HASH_STRUCT(EgJoltShapeKey, EgJoltShapeKeyHash, (uint32)t.type, t.params[0], t.params[1], t.params[2], t.params[3])
+
+/// Hands out one shared shape for every distinct key so identical bodies do not each build and hold their own copy.
+/// Only box, sphere and capsule shapes go through it; meshes are built per body. Shapes stay registered until pruned,
+/// even when no body uses them anymore.
+class EgJoltShapeRegistry final
+{
+public:
+	template<typename F>
+	ShapeRefC GetOrCreate(const EgJoltShapeKey& key, const F& createShape)
+	{
+		{
+			lock_guard lock(mMutex);
+			auto it = mShapes.find(key);
+			if (it != mShapes.end())
+			{
+				mHitCount++;
+				return it->second;
+			}
+		}
+
+		// Build outside of the lock. If another thread registered the same key in the meantime its shape wins.
+		ShapeSettings::ShapeResult result = createShape();
+		if (!result.IsValid())
+			return nullptr;
+
+		lock_guard lock(mMutex);
+		auto inserted = mShapes.try_emplace(key, result.Get());
+		if (inserted.second)
+			mMissCount++;
+		else
+			mHitCount++;
+		return inserted.first->second;
+	}
+
+	/// Releases shapes that only the registry still holds on to.
+	unsigned int Prune()
+	{
+		lock_guard lock(mMutex);
+
+		Array<EgJoltShapeKey> unused;
+		for (auto& entry : mShapes)
+		{
+			if (entry.second->GetRefCount() == 1)
+				unused.push_back(entry.first);
+		}
+		for (auto& key : unused)
+		{
+			mShapes.erase(key);
+		}
+		return (unsigned int)unused.size();
+	}
+
+	void Clear()
+	{
+		lock_guard lock(mMutex);
+		mShapes.clear();
+	}
+
+	EgJoltShapeRegistryStats GetStats()
+	{
+		lock_guard lock(mMutex);
+
+		EgJoltShapeRegistryStats stats = {};
+		stats.shapeCount = (unsigned int)mShapes.size();
+		stats.hitCount = mHitCount;
+		stats.missCount = mMissCount;
+
+		Shape::VisitedShapes visitedShapes;
+		for (auto& entry : mShapes)
+		{
+			uint64 size = entry.second->GetStatsRecursive(visitedShapes).mSizeBytes;
+			stats.memoryBytes += size;
+
+			// Every user past the first would have had its own copy without the registry
+			uint32 userCount = entry.second->GetRefCount() - 1;
+			if (userCount > 1)
+				stats.savedMemoryBytes += size * (userCount - 1);
+		}
+		return stats;
+	}
+
+private:
+	mutex mMutex;
+	UnorderedMap<EgJoltShapeKey, ShapeRefC, EgJoltShapeKeyHash> mShapes;
+	uint64 mHitCount = 0;
+	uint64 mMissCount = 0;
+};
+
+static EgJoltShapeRegistry* s_shapeRegistry = nullptr;
+
+inline ShapeRefC _egJoltGetBoxShape(EgJoltVector3 scale, float density)
+{
+	return s_shapeRegistry->GetOrCreate({ EgJoltShapeType::Box, { scale.x, scale.y, scale.z, density }, }, [=]()
+	{
+		BoxShapeSettings settings(Vec3(scale.x, scale.y, scale.z), 0);
+		settings.mDensity = density;
+		return settings.Create();
+	});
+}
+
+inline ShapeRefC _egJoltGetSphereShape(float radius, float density)
+{
+	return s_shapeRegistry->GetOrCreate({ EgJoltShapeType::Sphere, { radius, density, 0, 0 }, }, [=]()
+	{
+		SphereShapeSettings settings(radius);
+		settings.mDensity = density;
+		return settings.Create();
+	});
+}
+
+/// Upright capsule with its bottom at the origin, used by the characters.
+inline ShapeRefC _egJoltGetCharacterShape(float height, float radius)
+{
+	return s_shapeRegistry->GetOrCreate({ EgJoltShapeType::Capsule, { height, radius, 0, 0 }, }, [=]()
+	{
+		//mStandingShape = RotatedTranslatedShapeSettings(Vec3(0, 0.5f * cCharacterHeightStanding + cCharacterRadiusStanding, 0), Quat::sIdentity(), new CapsuleShape(0.5f * cCharacterHeightStanding, cCharacterRadiusStanding)).Create().Get();
+		auto rot = Quat::sRotation(Vec3::sAxisX(), DegreesToRadians(90));
+		return RotatedTranslatedShapeSettings(Vec3(0, 0, 0.5f * height + radius), rot, new CapsuleShape(0.5f * height, radius)).Create();
+	});
+}
+
+inline unsigned int _egJoltAddBodyBox(EgJoltInstance instance, EgJoltVector3 scale, EMotionType motionType, ObjectLayer layer, float density, float mass, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
+{
+	return _egJoltAddBody(instance, motionType, layer, mass, _egJoltGetBoxShape(scale, density), userData, bodyId, state, options);
+}
+
+inline unsigned int _egJoltAddBodySphere(EgJoltInstance instance, float radius, EMotionType motionType, ObjectLayer layer, float density, float mass, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
+{
+	return _egJoltAddBody(instance, motionType, layer, mass, _egJoltGetSphereShape(radius, density), userData, bodyId, state, options);
+}
+
+inline ShapeSettings::ShapeResult _egJoltCreateMeshShape(const EgJoltVector3* vertices, int vertexCount, const unsigned int* indices, int indexCount)
+{
+	auto vertexListCount = vertexCount;
+	auto vertexList = VertexList(vertexListCount);
+	auto indexListCount = indexCount / 3;
+	auto indexList = IndexedTriangleList(indexListCount);
+
+	for (int i = 0; i < vertexListCount; i++)
+	{
+		auto v = vertices[i];
+		vertexList[i] = Float3(v.x, v.y, v.z);
+	}
+
+	for (int i = 0; i < indexListCount; i++)
+	{
+		indexList[i] = IndexedTriangle(indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]);
+	}
+
+	MeshShapeSettings settings(std::move(vertexList), std::move(indexList));
+	return settings.Create();
+}
+
+inline unsigned int _egJoltAddBodyMesh(EgJoltInstance instance, EgJoltVector3* vertices, int vertexCount, unsigned int* indices, int indexCount, EMotionType motionType, ObjectLayer layer, float mass, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
+{
+	ShapeSettings::ShapeResult result = _egJoltCreateMeshShape(vertices, vertexCount, indices, indexCount);
+	if (!result.IsValid())
+		return BodyID::cInvalidBodyID;
+	return _egJoltAddBody(instance, motionType, layer, mass, result.Get(), userData, bodyId, state, options);
+}
+
+inline ShapeSettings::ShapeResult _egJoltCreateCompoundMeshShape(const EgJoltCompoundMesh& compoundMesh)
+{
+	Ref<StaticCompoundShapeSettings> compoundShapeSettings = new StaticCompoundShapeSettings;
+
+	for (unsigned int k = 0; k < compoundMesh.meshCount; k++)
+	{
+		auto mesh = compoundMesh.meshes[k];
+		auto vertexCount = mesh.vertexCount;
+		auto vertices = mesh.vertices;
+		auto indexCount = mesh.indexCount;
+		auto indices = mesh.indices;
+
+		auto vertexListCount = vertexCount;
+		auto vertexList = VertexList(vertexListCount);
+		auto indexListCount = indexCount / 3;
+		auto indexList = IndexedTriangleList(indexListCount);
+
+		for (unsigned int i = 0; i < vertexListCount; i++)
+		{
+			auto v = vertices[i];
+			vertexList[i] = Float3(v.x, v.y, v.z);
+		}
+
+		for (unsigned int i = 0; i < indexListCount; i++)
+		{
+			indexList[i] = IndexedTriangle(indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]);
+		}
+
+		MeshShapeSettings settings(std::move(vertexList), std::move(indexList));
+		compoundShapeSettings->AddShape(Vec3Arg::sZero(), QuatArg::sIdentity(), settings.Create().Get());	
+	}
+
+	return compoundShapeSettings->Create();
+}
+
+inline unsigned int _egJoltAddStaticBodyCompoundMesh(EgJoltInstance instance, EgJoltCompoundMesh compoundMesh, EMotionType motionType, ObjectLayer layer, float mass, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
+{
+	ShapeSettings::ShapeResult result = _egJoltCreateCompoundMeshShape(compoundMesh);
+	if (!result.IsValid())
+		return BodyID::cInvalidBodyID;
+	return _egJoltAddBody(instance, motionType, layer, mass, result.Get(), userData, bodyId, state, options);
+}
+
+/* SHAPE CACHE */
+
+// Bump when the layout of a shape blob changes so old caches are rebuilt instead of misread.
+static constexpr uint32 cShapeBlobMagic = 0x48534745; // 'EGSH'
+static constexpr uint32 cShapeBlobVersion = 1;
+
+inline uint64 _egJoltHashMesh(const EgJoltVector3* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount, uint64 hash)
+{
+	hash = HashBytes(&vertexCount, sizeof(vertexCount), hash);
+	hash = HashBytes(vertices, vertexCount * sizeof(EgJoltVector3), hash);
+	hash = HashBytes(&indexCount, sizeof(indexCount), hash);
+	return HashBytes(indices, indexCount * sizeof(unsigned int), hash);
+}
+
+inline uint64 _egJoltHashCompoundMesh(const EgJoltCompoundMesh& compoundMesh)
+{
+	uint64 hash = HashBytes(&compoundMesh.meshCount, sizeof(compoundMesh.meshCount));
+	for (unsigned int i = 0; i < compoundMesh.meshCount; i++)
+	{
+		auto& mesh = compoundMesh.meshes[i];
+		hash = _egJoltHashMesh(mesh.vertices, mesh.vertexCount, mesh.indices, mesh.indexCount, hash);
+	}
+	return hash;
+}
+
+/// Written in front of every shape blob. Jolt's binary shape format depends on its version and build configuration, so both are recorded.
+struct EgJoltShapeBlobHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint64 joltVersion;
+	uint64 contentHash;
+};
+
+inline void _egJoltSaveShape(const Shape* shape, uint64 contentHash, StreamOut& stream)
+{
+	EgJoltShapeBlobHeader header = { cShapeBlobMagic, cShapeBlobVersion, JPH_VERSION_ID, contentHash };
+	stream.Write(header);
+
+	Shape::ShapeToIDMap shapeMap;
+	Shape::MaterialToIDMap materialMap;
+	shape->SaveWithChildren(stream, shapeMap, materialMap);
+}
+
+inline Shape::ShapeResult _egJoltLoadShape(StreamIn& stream, uint64 contentHash)
+{
+	Shape::ShapeResult result;
+
+	EgJoltShapeBlobHeader header;
+	stream.Read(header);
+	if (stream.IsFailed() || header.magic != cShapeBlobMagic || header.version != cShapeBlobVersion || header.joltVersion != JPH_VERSION_ID)
+	{
+		result.SetError("Shape blob was written by a different version.");
+		return result;
+	}
+
+	if (header.contentHash != contentHash)
+	{
+		result.SetError("Shape blob was built from different geometry.");
+		return result;
+	}
+
+	Shape::IDToShapeMap shapeMap;
+	Shape::IDToMaterialMap materialMap;
+	return Shape::sRestoreWithChildren(stream, shapeMap, materialMap);
+}
+
+/* SCENE EXPORT */
+
+static constexpr uint32 cSceneBlobMagic = 0x43534745; // 'EGSC'
+static constexpr uint32 cSceneBlobVersion = 1;
+
+/// Written in front of every scene blob. Positions are stored at build precision, so the size of Real is recorded next to the Jolt version.
+struct EgJoltSceneBlobHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint64 joltVersion;
+	uint32 realSize;
+	uint32 bodyCount;
+};
+
+/// What Jolt's binary body format leaves out, one per body of the scene.
+struct EgJoltSceneBody
+{
+	uint64 userData;
+	uint32 bodyId;
+	uint32 flags;
+};
+
+inline bool _egJoltIsValidSceneBlobHeader(const EgJoltSceneBlobHeader& header)
+{
+	return header.magic == cSceneBlobMagic && header.version == cSceneBlobVersion && header.joltVersion == JPH_VERSION_ID && header.realSize == sizeof(Real);
+}
+
+inline void _egJoltExportScene(EgJoltInstanceInternal* internalInstance, uint64 layerMask, StreamOut& stream)
+{
+	auto physicsSystem = internalInstance->physics_system;
+	auto& lockInterface = physicsSystem->GetBodyLockInterfaceNoLock();
+
+	Array<BodyID> bodies;
+	physicsSystem->GetBodies(bodies);
+
+	// Sorted so the same world always gives the same blob
+	QuickSort(bodies.begin(), bodies.end());
+
+	PhysicsScene scene;
+	Array<EgJoltSceneBody> sceneBodies;
+	for (BodyID bodyId : bodies)
+	{
+		const Body* body = lockInterface.TryGetBody(bodyId);
+
+		// Parked pooled bodies are not part of the world
+		if (!body || !body->IsInBroadPhase() || (layerMask & (uint64(1) << body->GetObjectLayer())) == 0)
+			continue;
+
+		scene.AddBody(body->GetBodyCreationSettings());
+		sceneBodies.push_back({ body->GetUserData(), ConvertBodyId(bodyId), (uint32)(body->IsActive() ? EgJolt_BodyFlags_IsActive : EgJolt_BodyFlags_None) });
+	}
+
+	EgJoltSceneBlobHeader header = { cSceneBlobMagic, cSceneBlobVersion, JPH_VERSION_ID, (uint32)sizeof(Real), (uint32)sceneBodies.size() };
+	stream.Write(header);
+	stream.Write(sceneBodies);
+
+	// Shapes and materials shared between bodies are written once
+	scene.SaveBinaryState(stream, true, true);
+}
+
+/// Keeps the exported body ids where they are still free, so references to them stay valid across a server restart.
+inline bool _egJoltImportScene(EgJoltInstanceInternal* internalInstance, StreamIn& stream, unsigned int* bodyIds, unsigned int bodyIdCapacity, unsigned int* bodyCount)
+{
+	EgJoltSceneBlobHeader header;
+	stream.Read(header);
+	if (stream.IsFailed() || !_egJoltIsValidSceneBlobHeader(header))
+		return false;
+
+	Array<EgJoltSceneBody> sceneBodies;
+	stream.Read(sceneBodies);
+	if (stream.IsFailed() || sceneBodies.size() != header.bodyCount)
+		return false;
+
+	PhysicsScene::PhysicsSceneResult sceneResult = PhysicsScene::sRestoreFromBinaryState(stream);
+	if (!sceneResult.IsValid() || stream.IsFailed())
+		return false;
+
+	Array<BodyCreationSettings>& bodySettings = sceneResult.Get()->GetBodies();
+	if (bodySettings.size() != sceneBodies.size())
+		return false;
+
+	if (bodyCount)
+	{
+		*bodyCount = (unsigned int)sceneBodies.size();
+	}
+
+	BodyInterface& bodyInterface = internalInstance->physics_system->GetBodyInterfaceNoLock();
+
+	// Every body gets its exported id first, so a body whose id is taken cannot take the id of a body that comes later
+	Array<Body*> bodies(sceneBodies.size(), nullptr);
+	for (size_t i = 0; i < sceneBodies.size(); i++)
+	{
+		bodySettings[i].mUserData = sceneBodies[i].userData; // Set before adding so the activation listener sees it
+		bodies[i] = bodyInterface.CreateBodyWithID(ConvertBodyId(sceneBodies[i].bodyId), bodySettings[i]);
+	}
+
+	bool isComplete = true;
+	for (size_t i = 0; i < sceneBodies.size(); i++)
+	{
+		if (!bodies[i])
+		{
+			bodies[i] = bodyInterface.CreateBody(bodySettings[i]); // Note that if we run out of bodies this can return nullptr
+			isComplete &= bodies[i] != nullptr;
+		}
+	}
+
+	// A partial scene is of no use to the caller, so the bodies that were created are destroyed again before they enter the world
+	if (!isComplete)
+	{
+		Array<BodyID> createdBodyIds;
+		for (size_t i = 0; i < bodies.size(); i++)
+		{
+			if (bodies[i])
+			{
+				createdBodyIds.push_back(bodies[i]->GetID());
+			}
+			if (i < bodyIdCapacity)
+			{
+				bodyIds[i] = BodyID::cInvalidBodyID;
+			}
+		}
+		if (!createdBodyIds.empty())
+		{
+			bodyInterface.DestroyBodies(createdBodyIds.data(), (int)createdBodyIds.size());
+		}
+		return false;
+	}
+
+	Array<BodyID> activeBodyIds;
+	Array<BodyID> inactiveBodyIds;
+	for (size_t i = 0; i < bodies.size(); i++)
+	{
+		if (i < bodyIdCapacity)
+		{
+			bodyIds[i] = ConvertBodyId(bodies[i]->GetID());
+		}
+
+		if (sceneBodies[i].flags & EgJolt_BodyFlags_IsActive)
+		{
+			activeBodyIds.push_back(bodies[i]->GetID());
+		}
+		else
+		{
+			inactiveBodyIds.push_back(bodies[i]->GetID());
+		}
+	}
+
+	internalInstance->snapshotBodiesChanged = true;
+	return _egJoltAddBodyBatches(internalInstance->physics_system, activeBodyIds, inactiveBodyIds) == sceneBodies.size();
+}
+
+/* HEIGHT FIELD */
+
+// Jolt height fields are Y up and sample (x, y) lies at (x, height, y). Rotating shape X to world Y, Y to Z and Z to X makes them Z up,
+// so with the samples transposed the sample (x, y) lies at world (x, y, height).
+static const Quat cHeightFieldRotation = Quat(0.5f, 0.5f, 0.5f, 0.5f);
+
+/// Copies a sizeX by sizeY row major grid into a sizeY by sizeX one.
+template<typename T>
+inline void _egJoltTranspose(const T* source, unsigned int sizeX, unsigned int sizeY, Array<T>& destination)
+{
+	destination.resize(sizeX * sizeY);
+	for (unsigned int y = 0; y < sizeY; y++)
+	{
+		for (unsigned int x = 0; x < sizeX; x++)
+		{
+			destination[x * sizeY + y] = source[y * sizeX + x];
+		}
+	}
+}
+
+inline ShapeSettings::ShapeResult _egJoltCreateHeightFieldShape(const EgJoltHeightFieldShapeSettings& settings)
+{
+	Array<float> samples;
+	_egJoltTranspose(settings.samples, settings.sampleCount, settings.sampleCount, samples);
+
+	Array<uint8> materialIndices;
+	PhysicsMaterialList materials;
+	if (settings.materialIndices && settings.materialCount > 0)
+	{
+		_egJoltTranspose(settings.materialIndices, settings.sampleCount - 1, settings.sampleCount - 1, materialIndices);
+		for (unsigned int i = 0; i < settings.materialCount; i++)
+		{
+			materials.push_back(new PhysicsMaterialSimple("HeightFieldMaterial", Color::sGetDistinctColor(i)));
+		}
+	}
+
+	// Swizzled the same way as the samples
+	HeightFieldShapeSettings jSettings(
+		samples.data(),
+		Vec3(settings.offset.y, settings.offset.z, settings.offset.x),
+		Vec3(settings.scale.y, settings.scale.z, settings.scale.x),
+		settings.sampleCount,
+		materialIndices.empty() ? nullptr : materialIndices.data(),
+		materials);
+	jSettings.mBlockSize = settings.blockSize;
+	jSettings.mBitsPerSample = settings.bitsPerSample;
+
+	auto jResult = jSettings.Create();
+	if (!jResult.IsValid())
+		return jResult;
+
+	return RotatedTranslatedShapeSettings(Vec3::sZero(), cHeightFieldRotation, jResult.Get()).Create();
+}
+
+inline const HeightFieldShape* _egJoltGetHeightFieldShape(const Shape* shape)
+{
+	if (shape->GetSubType() != EShapeSubType::RotatedTranslated)
+		return nullptr;
+
+	auto innerShape = static_cast<const RotatedTranslatedShape*>(shape)->GetInnerShape();
+	if (innerShape->GetSubType() != EShapeSubType::HeightField)
+		return nullptr;
+
+	return static_cast<const HeightFieldShape*>(innerShape);
+}
+
+inline bool _egJoltSetHeightFieldHeights(EgJoltInstanceInternal* internalInstance, BodyID bodyId, unsigned int x, unsigned int y, unsigned int sizeX, unsigned int sizeY, const float* heights)
+{
+	BodyInterface& bodyInterface = internalInstance->physics_system->GetBodyInterfaceNoLock();
+
+	ShapeRefC shape = bodyInterface.GetShape(bodyId);
+	if (!shape)
+		return false;
+
+	auto heightField = const_cast<HeightFieldShape*>(_egJoltGetHeightFieldShape(shape));
+	if (!heightField)
+		return false;
+
+	unsigned int blockSize = heightField->GetBlockSize();
+	unsigned int sampleCount = heightField->GetSampleCount();
+	if (x % blockSize != 0 || y % blockSize != 0 || sizeX % blockSize != 0 || sizeY % blockSize != 0 || x + sizeX > sampleCount || y + sizeY > sampleCount)
+		return false;
+
+	// In height field space x and y are swapped
+	Array<float> transposedHeights;
+	_egJoltTranspose(heights, sizeX, sizeY, transposedHeights);
+	heightField->SetHeights(y, x, sizeY, sizeX, transposedHeights.data(), sizeY, *internalInstance->temp_allocator);
+
+	bodyInterface.NotifyShapeChanged(bodyId, shape->GetCenterOfMass(), false, EActivation::DontActivate);
+
+	// Wake up whatever rests on the changed area, including the block border that got recompressed
+	unsigned int startX = y > 0 ? y - 1 : 0;
+	unsigned int startY = x > 0 ? x - 1 : 0;
+	Vec3 start = heightField->GetPosition(startX, startY);
+	Vec3 end = heightField->GetPosition(min(y + sizeY, sampleCount - 1), min(x + sizeX, sampleCount - 1));
+	AABox region(Vec3(start.GetX(), heightField->GetMinHeightValue(), start.GetZ()), Vec3(end.GetX(), heightField->GetMaxHeightValue(), end.GetZ()));
+
+	auto rotatedTranslated = static_cast<const RotatedTranslatedShape*>(shape.GetPtr());
+	RMat44 transform = bodyInterface.GetWorldTransform(bodyId) * Mat44::sRotationTranslation(rotatedTranslated->GetRotation(), rotatedTranslated->GetPosition());
+	bodyInterface.ActivateBodiesInAABox(region.Transformed(transform), { }, { });
+	return true;
+}
+
+/* CONVEX HULLS */
+
+// Same tolerance ConvexHullShapeSettings uses
+static constexpr float cHullTolerance = 1.0e-3f;
+
+/// Builds the hull of points with at most maxVertexCount vertices and returns the points that ended up on it.
+inline bool _egJoltBuildHull(const Array<Vec3>& points, unsigned int maxVertexCount, Array<Vec3>& outHullPoints, Array<Plane>* outPlanes = nullptr)
+{
+	ConvexHullBuilder builder(points);
+	const char* error = nullptr;
+	auto result = builder.Initialize(maxVertexCount > 0 ? (int)maxVertexCount : INT_MAX, cHullTolerance, error);
+	if (result != ConvexHullBuilder::EResult::Success && result != ConvexHullBuilder::EResult::MaxVerticesReached)
+		return false;
+
+	UnorderedSet<int> usedIndices;
+	for (const ConvexHullBuilder::Face* face : builder.GetFaces())
+	{
+		const ConvexHullBuilder::Edge* edge = face->mFirstEdge;
+		do
+		{
+			usedIndices.insert(edge->mStartIdx);
+			edge = edge->mNextEdge;
+		} while (edge != face->mFirstEdge);
+
+		if (outPlanes)
+			outPlanes->push_back(Plane::sFromPointAndNormal(face->mCentroid, face->mNormal.Normalized()));
+	}
+
+	// Keep the original order of the points so the result does not depend on hashing
+	outHullPoints.clear();
+	for (int i = 0; i < (int)points.size(); i++)
+	{
+		if (usedIndices.find(i) != usedIndices.end())
+			outHullPoints.push_back(points[i]);
+	}
+	return true;
+}
+
+inline ShapeSettings::ShapeResult _egJoltCreateConvexHullShape(const Array<Vec3>& points, unsigned int maxVertexCount, float density)
+{
+	Array<Vec3> hullPoints;
+	if (!_egJoltBuildHull(points, maxVertexCount, hullPoints))
+	{
+		ShapeSettings::ShapeResult result;
+		result.SetError("Failed to build convex hull.");
+		return result;
+	}
+
+	ConvexHullShapeSettings settings(hullPoints);
+	settings.mDensity = density;
+	settings.mHullTolerance = cHullTolerance;
+	return settings.Create();
+}
+
+/// A group of triangles of the mesh that is being decomposed, along with how far its hull strays from it.
+struct EgJoltDecompositionPart
+{
+	Array<uint32> triangles;
+	Array<Vec3> hullPoints;
+	float concavity = 0;
+};
+
+/// The hull of the part's vertices, and how deep the part's vertices and triangle centers lie below the surface of that hull.
+inline bool _egJoltEvaluateDecompositionPart(const EgJoltMesh& mesh, unsigned int maxVertexCount, EgJoltDecompositionPart& part)
+{
+	Array<Vec3> points;
+	Array<Vec3> samples;
+	for (uint32 triangle : part.triangles)
+	{
+		Vec3 v0 = ConvertVector3(mesh.vertices[mesh.indices[triangle * 3]]);
+		Vec3 v1 = ConvertVector3(mesh.vertices[mesh.indices[triangle * 3 + 1]]);
+		Vec3 v2 = ConvertVector3(mesh.vertices[mesh.indices[triangle * 3 + 2]]);
+		points.push_back(v0);
+		points.push_back(v1);
+		points.push_back(v2);
+		samples.push_back((v0 + v1 + v2) / 3.0f);
+	}
+
+	Array<Plane> planes;
+	if (!_egJoltBuildHull(points, maxVertexCount, part.hullPoints, &planes))
+		return false;
+
+	samples.insert(samples.end(), points.begin(), points.end());
+
+	part.concavity = 0;
+	for (Vec3 sample : samples)
+	{
+		float depth = FLT_MAX;
+		for (const Plane& plane : planes)
+		{
+			depth = min(depth, -plane.SignedDistance(sample));
+		}
+		part.concavity = max(part.concavity, depth);
+	}
+	return true;
+}
+
+/// Splits the part in two by the triangle centers along the longest axis of its bounds. Fails when everything ends up on one side.
+inline bool _egJoltSplitDecompositionPart(const EgJoltMesh& mesh, const EgJoltDecompositionPart& part, EgJoltDecompositionPart& outLeft, EgJoltDecompositionPart& outRight)
+{
+	AABox bounds;
+	Array<Vec3> centers;
+	for (uint32 triangle : part.triangles)
+	{
+		Vec3 v0 = ConvertVector3(mesh.vertices[mesh.indices[triangle * 3]]);
+		Vec3 v1 = ConvertVector3(mesh.vertices[mesh.indices[triangle * 3 + 1]]);
+		Vec3 v2 = ConvertVector3(mesh.vertices[mesh.indices[triangle * 3 + 2]]);
+		centers.push_back((v0 + v1 + v2) / 3.0f);
+		bounds.Encapsulate(centers.back());
+	}
+
+	int axis = bounds.GetExtent().GetHighestComponentIndex();
+	float split = bounds.GetCenter()[axis];
+	for (size_t i = 0; i < part.triangles.size(); i++)
+	{
+		(centers[i][axis] < split ? outLeft : outRight).triangles.push_back(part.triangles[i]);
+	}
+	return !outLeft.triangles.empty() && !outRight.triangles.empty();
+}
+
+/// Approximate convex decomposition: keeps splitting the part that is furthest from convex until every part is within maxConcavity or maxHulls is reached.
+/// Every part becomes a convex hull of its vertices, the hulls are combined in a StaticCompoundShape.
+inline ShapeSettings::ShapeResult _egJoltCreateConvexDecompositionShape(const EgJoltMesh& mesh, const EgJoltConvexDecompositionSettings& settings)
+{
+	ShapeSettings::ShapeResult result;
+
+	unsigned int maxHulls = max(settings.maxHulls, 1u);
+	// Parts that cannot be split are given a concavity of 0, so the loop below only ends on a concavity that 0 satisfies
+	float maxConcavity = settings.maxConcavity > 0 ? settings.maxConcavity : 0.0f;
+
+	Array<EgJoltDecompositionPart> parts(1);
+	for (uint32 i = 0; i < mesh.indexCount / 3; i++)
+	{
+		parts[0].triangles.push_back(i);
+	}
+	if (parts[0].triangles.empty() || !_egJoltEvaluateDecompositionPart(mesh, settings.maxVerticesPerHull, parts[0]))
+	{
+		result.SetError("Failed to build convex hull.");
+		return result;
+	}
+
+	while (parts.size() < maxHulls)
+	{
+		size_t worst = 0;
+		for (size_t i = 1; i < parts.size(); i++)
+		{
+			if (parts[i].concavity > parts[worst].concavity)
+				worst = i;
+		}
+		if (parts[worst].concavity <= maxConcavity)
+			break;
+
+		EgJoltDecompositionPart left, right;
+		if (!_egJoltSplitDecompositionPart(mesh, parts[worst], left, right) ||
+			!_egJoltEvaluateDecompositionPart(mesh, settings.maxVerticesPerHull, left) ||
+			!_egJoltEvaluateDecompositionPart(mesh, settings.maxVerticesPerHull, right))
+		{
+			// Flat or degenerate pieces cannot be split any further
+			parts[worst].concavity = 0;
+			continue;
+		}
+
+		parts[worst] = std::move(left);
+		parts.push_back(std::move(right));
+	}
+
+	if (parts.size() == 1)
+		return _egJoltCreateConvexHullShape(parts[0].hullPoints, 0, settings.density);
+
+	Ref<StaticCompoundShapeSettings> compoundSettings = new StaticCompoundShapeSettings;
+	for (auto& part : parts)
+	{
+		auto hullResult = _egJoltCreateConvexHullShape(part.hullPoints, 0, settings.density);
+		if (!hullResult.IsValid())
+			return hullResult;
+
+		compoundSettings->AddShape(Vec3::sZero(), Quat::sIdentity(), hullResult.Get());
+	}
+	return compoundSettings->Create();
+}
+
+CharacterVirtual* GetInternalCharacterVirtual(EgJoltCharacterVirtual egCharacter)
+{
+	return (CharacterVirtual*)egCharacter.internal;
+}
+
+Character* GetInternalCharacter(EgJoltCharacter egCharacter)
+{
+	return (Character*)egCharacter.internal;
+}
+
+inline EgJoltCharacterVirtual _egJoltCreateCharacterVirtual(EgJoltInstance instance, EgJoltCharacterSettings& settings, EgJoltVector3 position)
+{
+	auto internal = GetInternalInstance(instance);
+	auto physics = internal->physics_system;
+
+	ShapeRefC standingShape = _egJoltGetCharacterShape(settings.standingHeight, settings.standingRadius);
+
+	Ref<CharacterVirtualSettings> virtualSettings = new CharacterVirtualSettings();
+	virtualSettings->mMaxSlopeAngle = settings.maxSlopeAngle;
+	virtualSettings->mMaxStrength = settings.maxStrength;
+	virtualSettings->mShape = standingShape;
+	virtualSettings->mBackFaceMode = EBackFaceMode::IgnoreBackFaces;
+	virtualSettings->mCharacterPadding = settings.padding;
+	virtualSettings->mPenetrationRecoverySpeed = settings.penetrationRecoverySpeed;
+	virtualSettings->mPredictiveContactDistance = settings.predictiveContactDistance;
+	virtualSettings->mSupportingVolume = Plane(Vec3::sAxisZ(), -settings.standingRadius); // Accept contacts that touch the lower sphere of the capsule
+	virtualSettings->mUp = Vec3::sAxisZ();
+	virtualSettings->mMass = settings.mass;
+	virtualSettings->mInnerBodyLayer = settings.layer;
+	virtualSettings->mEnhancedInternalEdgeRemoval = true;
+
+	auto jCharacterVirtual = new CharacterVirtual(virtualSettings, ConvertRVec3(position), Quat::sIdentity(), physics);
+	jCharacterVirtual->SetListener(internal->characterContactListener);
+	internal->characterVirtuals.push_back(jCharacterVirtual);
+	internal->maxCharacterPredictiveContactDistance = max(internal->maxCharacterPredictiveContactDistance, settings.predictiveContactDistance);
+
+	EgJoltCharacterVirtual character = {};
+	character.internal = jCharacterVirtual;
+	return character;
+}
+
+inline void _egJoltUpdateCharacterVirtual(EgJoltInstanceInternal* internalInstance, CharacterVirtual* characterVirtual, float deltaTime, const EgJoltCharacterVirtualUpdateSettings& updateSettings, TempAllocator& tempAllocator)
+{
+	auto physics = internalInstance->physics_system;
+
+	CharacterVirtual::ExtendedUpdateSettings settings;
+	settings.mStickToFloorStepDown = ConvertVector3(updateSettings.stickToFloorStepDown);
+	settings.mWalkStairsStepUp = ConvertVector3(updateSettings.walkStairsStepUp);
+	settings.mWalkStairsCosAngleForwardContact = updateSettings.walkStairsCosAngleForwardContact;
+	settings.mWalkStairsStepDownExtra = ConvertVector3(updateSettings.walkStairsStepDownExtra);
+	settings.mWalkStairsStepForwardTest = updateSettings.walkStairsStepForwardTest;
+	settings.mWalkStairsMinStepForward = updateSettings.walkStairsMinStepForward;
+
+	characterVirtual->ExtendedUpdate(
+		deltaTime,
+		-characterVirtual->GetUp() * physics->GetGravity().Length(),
+		settings,
+		physics->GetDefaultBroadPhaseLayerFilter(updateSettings.layer),
+		physics->GetDefaultLayerFilter(updateSettings.layer),
+		(*internalInstance->bodyFilter),
+		{ },
+		tempAllocator
+	);
+}
+
+inline unsigned int _egJoltFindGroup(Array<unsigned int>& parents, unsigned int index)
+{
+	while (parents[index] != index)
+	{
+		parents[index] = parents[parents[index]];
+		index = parents[index];
+	}
+	return index;
+}
+
+// Characters can only touch each other when the space they can reach this update overlaps, so overlapping characters are put in the same group.
+// Groups are updated in parallel, the characters within a group one after the other so they only ever see each other at rest.
+inline void _egJoltUpdateCharacterVirtuals(EgJoltInstanceInternal* internalInstance, const EgJoltCharacterVirtual* characters, unsigned int count, const EgJoltCharacterVirtualUpdateSettings& updateSettings, float deltaTime)
+{
+	float stepReach = ConvertVector3(updateSettings.stickToFloorStepDown).Length()
+		+ ConvertVector3(updateSettings.walkStairsStepUp).Length()
+		+ ConvertVector3(updateSettings.walkStairsStepDownExtra).Length()
+		+ updateSettings.walkStairsStepForwardTest
+		+ internalInstance->maxCharacterPredictiveContactDistance;
+
+	Array<AABox> reach(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		CharacterVirtual* characterVirtual = GetInternalCharacterVirtual(characters[i]);
+		reach[i] = characterVirtual->GetShape()->GetWorldSpaceBounds(characterVirtual->GetCenterOfMassTransform(), Vec3::sOne());
+		reach[i].ExpandBy(Vec3::sReplicate(characterVirtual->GetLinearVelocity().Length() * deltaTime + characterVirtual->GetCharacterPadding() + stepReach));
+	}
+
+	Array<unsigned int> parents(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		parents[i] = i;
+	}
+	for (unsigned int i = 0; i < count; i++)
+	{
+		for (unsigned int j = i + 1; j < count; j++)
+		{
+			if (reach[i].Overlaps(reach[j]))
+			{
+				parents[_egJoltFindGroup(parents, j)] = _egJoltFindGroup(parents, i);
+			}
+		}
+	}
+
+	// Group members are kept in the order they were given so the result does not depend on thread timing
+	Array<Array<CharacterVirtual*>> groups;
+	Array<unsigned int> groupIndices(count, ~0u);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int root = _egJoltFindGroup(parents, i);
+		if (groupIndices[root] == ~0u)
+		{
+			groupIndices[root] = (unsigned int)groups.size();
+			groups.emplace_back();
+		}
+		groups[groupIndices[root]].push_back(GetInternalCharacterVirtual(characters[i]));
+	}
+
+	// Every job gets its own temp allocator
+	JobSystem* jobSystem = internalInstance->job_system;
+	auto& tempAllocators = internalInstance->characterTempAllocators;
+	while (tempAllocators.size() < (size_t)jobSystem->GetMaxConcurrency())
+	{
+		tempAllocators.push_back(new TempAllocatorImplWithMallocFallback(1024 * 1024));
+	}
+
+	_egJoltParallelForJobs(jobSystem, (unsigned int)groups.size(), 1, [&](unsigned int jobIndex, unsigned int start, unsigned int end)
+	{
+		TempAllocator& tempAllocator = *tempAllocators[jobIndex];
+		for (unsigned int groupIndex = start; groupIndex < end; groupIndex++)
+		{
+			Array<CharacterVirtual*>& group = groups[groupIndex];
+
+			CharacterVsCharacterCollisionSimple characterVsCharacter;
+			if (group.size() > 1)
+			{
+				characterVsCharacter.mCharacters = group;
+			}
+
+			for (CharacterVirtual* characterVirtual : group)
+			{
+				characterVirtual->SetCharacterVsCharacterCollision(group.size() > 1 ? &characterVsCharacter : nullptr);
+				_egJoltUpdateCharacterVirtual(internalInstance, characterVirtual, deltaTime, updateSettings, tempAllocator);
+				characterVirtual->SetCharacterVsCharacterCollision(nullptr);
+			}
+		}
+	});
+}
+
+inline EgJoltCharacter _egJoltCreateCharacter(EgJoltInstance instance, EgJoltCharacterSettings& settings, EgJoltVector3 position, ObjectLayer layer, unsigned long long userData)
+{
+	auto internal = GetInternalInstance(instance);
+	auto physics = internal->physics_system;
+
+	ShapeRefC standingShape = _egJoltGetCharacterShape(settings.standingHeight, settings.standingRadius);
+
+	Ref<CharacterSettings> jSettings = new CharacterSettings();
+	jSettings->mMass = settings.mass;
+	jSettings->mMaxSlopeAngle = settings.maxSlopeAngle;
+	jSettings->mShape = standingShape;
+	jSettings->mLayer = layer;
+	jSettings->mUp = Vec3::sAxisZ();
+	jSettings->mSupportingVolume = Plane(Vec3::sAxisZ(), -settings.standingRadius); // Accept contacts that touch the lower sphere of the capsule
+	jSettings->mEnhancedInternalEdgeRemoval = true;
+
+	auto jCharacter = new Character(jSettings, ConvertRVec3(position), Quat::sIdentity(), userData, physics);
+	jCharacter->AddToPhysicsSystem(EActivation::Activate);
+	internal->snapshotBodiesChanged = true;
+
+	EgJoltCharacter character = {};
+	character.internal = jCharacter;
+	return character;
+}
+
+inline void _egJoltSaveState(EgJoltInstance instance, EgJolt_StateFlags flags, EgJoltMemoryStateRecorder& recorder)
+{
+	auto internal = GetInternalInstance(instance);
+
+	EgJoltActiveDynamicBodiesStateFilter filter;
+	filter.lockInterface = &internal->physics_system->GetBodyLockInterfaceNoLock();
+
+	const StateRecorderFilter* stateFilter = nullptr;
+	if (flags & EgJolt_StateFlags_ActiveDynamicBodiesOnly)
+	{
+		stateFilter = &filter;
+	}
+
+	internal->physics_system->SaveState(recorder, EStateRecorderState::All, stateFilter);
+
+	// Virtual characters are not bodies, so the physics system does not know about them.
+	recorder.Write((uint32)internal->characterVirtuals.size());
+	for (auto characterVirtual : internal->characterVirtuals)
+	{
+		characterVirtual->SaveState(recorder);
+	}
+}
+
+inline bool _egJoltRestoreState(EgJoltInstance instance, EgJoltMemoryStateRecorder& recorder)
+{
+	auto internal = GetInternalInstance(instance);
+
+	if (!internal->physics_system->RestoreState(recorder))
+	{
+		return false;
+	}
+
+	uint32 characterVirtualCount = 0;
+	recorder.Read(characterVirtualCount);
+	if (characterVirtualCount != internal->characterVirtuals.size())
+	{
+		return false;
+	}
+
+	for (auto characterVirtual : internal->characterVirtuals)
+	{
+		characterVirtual->RestoreState(recorder);
+	}
+
+	return !recorder.IsFailed();
+}
+
+inline uint64 _egJoltGetContactPairKey(unsigned int bodyId1, unsigned int bodyId2)
+{
+	return bodyId1 < bodyId2 ? (uint64(bodyId1) << 32) | bodyId2 : (uint64(bodyId2) << 32) | bodyId1;
+}
+
+// Rebuilds the set of touching body pairs from the contact events of the last step.
+// Bodies that fell asleep stop reporting contacts (Jolt reports them as removed), so pairs where neither body is awake are carried over.
+inline void _egJoltUpdateContactPairs(EgJoltInstanceInternal* internalInstance)
+{
+	auto& lockInterface = internalInstance->physics_system->GetBodyLockInterfaceNoLock();
+	auto& contactPairs = internalInstance->contactPairs;
+	auto& keptPairs = internalInstance->contactPairsScratch;
+	auto& contactQueue = internalInstance->contact_listener->contactQueue;
+
+	// When events were dropped the queue does not hold every touching pair, so the pairs of the last step are kept
+	// and only new ones are added. Pairs that separated during this step are then removed after the next step.
+	if (contactQueue.GetDroppedCount() == 0)
+	{
+		keptPairs.clear();
+		for (uint64 key : contactPairs)
+		{
+			const Body* body1 = lockInterface.TryGetBody(ConvertBodyId((unsigned int)(key >> 32)));
+			const Body* body2 = lockInterface.TryGetBody(ConvertBodyId((unsigned int)key));
+			if (body1 && body2 && body1->IsInBroadPhase() && body2->IsInBroadPhase() && !body1->IsActive() && !body2->IsActive())
+			{
+				keptPairs.push_back(key);
+			}
+		}
+
+		contactPairs.clear();
+		for (uint64 key : keptPairs)
+		{
+			contactPairs.insert(key);
+		}
+	}
+
+	// Speculative contacts of bodies that are close but not touching yet are not counted
+	unsigned int count = contactQueue.GetCount();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const EgJoltContactArgs& args = contactQueue.events[i];
+		if (args.contactEvent != EgJolt_ContactEvent_Removed && args.penetrationDepth >= 0.0f)
+		{
+			contactPairs.insert(_egJoltGetContactPairKey(args.bodyId1, args.bodyId2));
+		}
+	}
+}
+
+// Turns the contact events of the last step into enter and exit events for sensors.
+// Jolt reports contacts per sub-shape pair, so a body is inside a sensor from its first sub-shape contact until its last one is removed.
+// Removed events carry nothing but the body ids, so what the exit event needs is remembered when the body enters.
+// Jolt also removes the contacts of a body that falls asleep and adds them again when it wakes up. Such an overlap is kept without contacts,
+// and only exits once the body is gone or awake without touching the sensor again.
+inline void _egJoltUpdateTriggers(EgJoltInstanceInternal* internalInstance)
+{
+	auto& lockInterface = internalInstance->physics_system->GetBodyLockInterfaceNoLock();
+	auto& sensorOverlaps = internalInstance->sensorOverlaps;
+	auto& triggerEvents = internalInstance->triggerEvents;
+
+	triggerEvents.clear();
+
+	auto isSleepingInside = [&](const EgJoltSensorOverlap& overlap)
+	{
+		const Body* sensor = lockInterface.TryGetBody(ConvertBodyId(overlap.sensorBodyId));
+		const Body* other = lockInterface.TryGetBody(ConvertBodyId(overlap.otherBodyId));
+		return sensor && other && sensor->IsInBroadPhase() && other->IsInBroadPhase() && !other->IsActive();
+	};
+
+	bool hasSleepingOverlaps = false;
+	internalInstance->contact_listener->sensorContactLog.ForEach([&](const EgJoltSensorContactLog::Entry& entry)
+	{
+		uint64 key = _egJoltGetContactPairKey(entry.bodyId1, entry.bodyId2);
+
+		if (entry.isAdded)
+		{
+			auto it = sensorOverlaps.find(key);
+			if (it != sensorOverlaps.end())
+			{
+				it->second.contactCount++;
+				return;
+			}
+
+			const Body* body1 = lockInterface.TryGetBody(ConvertBodyId(entry.bodyId1));
+			const Body* body2 = lockInterface.TryGetBody(ConvertBodyId(entry.bodyId2));
+			if (!body1 || !body2 || body1->IsSensor() == body2->IsSensor())
+				return;
+
+			const Body* sensor = body1->IsSensor() ? body1 : body2;
+			const Body* other = body1->IsSensor() ? body2 : body1;
+
+			EgJoltSensorOverlap overlap;
+			overlap.contactCount = 1;
+			overlap.sensorBodyId = ConvertBodyId(sensor->GetID());
+			overlap.otherBodyId = ConvertBodyId(other->GetID());
+			overlap.sensorUserData = sensor->GetUserData();
+			overlap.otherUserData = other->GetUserData();
+			overlap.otherLayer = (unsigned char)other->GetObjectLayer();
+			sensorOverlaps.insert({ key, overlap });
+
+			triggerEvents.push_back({ overlap.sensorBodyId, overlap.sensorUserData, overlap.otherBodyId, overlap.otherUserData, overlap.otherLayer, EgJolt_TriggerEvent_Enter });
+		}
+		else
+		{
+			auto it = sensorOverlaps.find(key);
+			if (it == sensorOverlaps.end() || it->second.contactCount == 0 || --it->second.contactCount > 0)
+				return;
+
+			const EgJoltSensorOverlap& overlap = it->second;
+			if (isSleepingInside(overlap))
+			{
+				hasSleepingOverlaps = true;
+				return;
+			}
+
+			triggerEvents.push_back({ overlap.sensorBodyId, overlap.sensorUserData, overlap.otherBodyId, overlap.otherUserData, overlap.otherLayer, EgJolt_TriggerEvent_Exit });
+			sensorOverlaps.erase(it);
+		}
+	});
+
+	// Overlaps kept for sleeping bodies from earlier steps exit once their body is removed, or wakes up without its contacts coming back
+	auto& sleepingOverlapCount = internalInstance->sleepingSensorOverlapCount;
+	if (!hasSleepingOverlaps && sleepingOverlapCount == 0)
+		return;
+
+	auto& exitedKeys = internalInstance->contactPairsScratch;
+	exitedKeys.clear();
+	sleepingOverlapCount = 0;
+	for (const auto& [key, overlap] : sensorOverlaps)
+	{
+		if (overlap.contactCount > 0)
+			continue;
+
+		if (isSleepingInside(overlap))
+		{
+			sleepingOverlapCount++;
+			continue;
+		}
+
+		triggerEvents.push_back({ overlap.sensorBodyId, overlap.sensorUserData, overlap.otherBodyId, overlap.otherUserData, overlap.otherLayer, EgJolt_TriggerEvent_Exit });
+		exitedKeys.push_back(key);
+	}
+
+	for (uint64 key : exitedKeys)
+	{
+		sensorOverlaps.erase(key);
+	}
+}
+
+// Bodies that were awake at some point during the last step, which are the only ones the step could have moved.
+// Bodies that fell asleep at the end of the step are no longer in Jolt's active list, so they are taken from the deactivations.
+inline void _egJoltUpdateChangedBodies(EgJoltInstanceInternal* internalInstance)
+{
+	PhysicsSystem* physicsSystem = internalInstance->physics_system;
+	auto& lockInterface = physicsSystem->GetBodyLockInterfaceNoLock();
+	auto& changedBodies = internalInstance->changedBodies;
+
+	internalInstance->body_activation_listener->SwapChanges(internalInstance->activationChanges);
+
+	changedBodies.clear();
+	const BodyID* activeBodies = physicsSystem->GetActiveBodiesUnsafe(EBodyType::RigidBody);
+	unsigned int activeBodyCount = physicsSystem->GetNumActiveBodies(EBodyType::RigidBody);
+	for (unsigned int i = 0; i < activeBodyCount; i++)
+	{
+		changedBodies.push_back(ConvertBodyId(activeBodies[i]));
+	}
+
+	bool hasDeactivations = false;
+	for (const EgJoltActivationChange& change : internalInstance->activationChanges)
+	{
+		// Removed bodies are deactivated too
+		if (!change.isActive && lockInterface.TryGetBody(ConvertBodyId(change.bodyId)))
+		{
+			changedBodies.push_back(change.bodyId);
+			hasDeactivations = true;
+		}
+	}
+
+	// Sorted so the transform sync visits bodies in the same order on every peer
+	QuickSort(changedBodies.begin(), changedBodies.end());
+	if (hasDeactivations)
+	{
+		changedBodies.erase(unique(changedBodies.begin(), changedBodies.end()), changedBodies.end());
+	}
+}
+
+/* STEPPING */
+// ------------------------------------
+
+// Steps the world and collects the contacts and moved bodies of the step. egJoltUpdateAsync runs this on the job system, so nothing in here may call into managed code.
+inline EgJoltUpdateStats _egJoltStep(EgJoltInstanceInternal* internalInstance, float deltaTime, int collisionSteps)
+{
+	auto contactListener = internalInstance->contact_listener;
+	auto& contactQueue = contactListener->contactQueue;
+
+	if (collisionSteps <= 0)
+	{
+		collisionSteps = internalInstance->collisionSteps;
+	}
+
+	contactQueue.Reset();
+	contactListener->sensorContactLog.Reset();
+	contactListener->contactCount = 0;
+	internalInstance->temp_allocator->GrowToHighWaterMark();
+	internalInstance->temp_allocator->ResetHighWaterMark();
+	_egJoltFlushBodyPools(internalInstance);
+
+	// Step the world
+	uint64 allocationCount = s_heapAllocationCount.load(memory_order_relaxed);
+	auto startTime = chrono::steady_clock::now();
+	EPhysicsUpdateError error = internalInstance->physics_system->Update(deltaTime, collisionSteps, internalInstance->temp_allocator, internalInstance->job_system);
+	auto stepTime = chrono::steady_clock::now();
+	internalInstance->allHeapAllocationsDuringStep = s_heapAllocationCount.load(memory_order_relaxed) - allocationCount;
+
+	_egJoltUpdateContactPairs(internalInstance);
+	_egJoltUpdateTriggers(internalInstance);
+	_egJoltUpdateChangedBodies(internalInstance);
+	auto endTime = chrono::steady_clock::now();
+
+	EgJoltUpdateStats stats = {};
+	stats.errors = (EgJolt_UpdateError)error;
+	stats.tempAllocatorHighWaterMark = (unsigned int)internalInstance->temp_allocator->GetHighWaterMark();
+	stats.activeBodyCount = internalInstance->physics_system->GetNumActiveBodies(EBodyType::RigidBody);
+	stats.contactCount = contactListener->contactCount;
+	stats.droppedContactEventCount = contactQueue.GetDroppedCount();
+	stats.stepMilliseconds = chrono::duration<float, milli>(stepTime - startTime).count();
+	stats.contactsMilliseconds = chrono::duration<float, milli>(endTime - stepTime).count();
+	return stats;
+}
+
+// Hands the contact events of the step to the callbacks given to egJoltCreateInstance, on the thread that asked for the update.
+inline void _egJoltRunContactCallbacks(EgJoltInstanceInternal* internalInstance, EgJoltUpdateStats& stats)
+{
+	if (!internalInstance->callbackContactAdded && !internalInstance->callbackContactPersisted)
+		return;
+
+	auto startTime = chrono::steady_clock::now();
+	auto& contactQueue = internalInstance->contact_listener->contactQueue;
+	unsigned int count = contactQueue.GetCount();
+	for (unsigned int i = contactQueue.readIndex; i < count; i++)
+	{
+		const EgJoltContactArgs& args = contactQueue.events[i];
+		if (args.contactEvent == EgJolt_ContactEvent_Added && internalInstance->callbackContactAdded)
+		{
+			internalInstance->callbackContactAdded(args);
+		}
+		else if (args.contactEvent == EgJolt_ContactEvent_Persisted && internalInstance->callbackContactPersisted)
+		{
+			internalInstance->callbackContactPersisted(args);
+		}
+	}
+	contactQueue.readIndex = count;
+	stats.contactsMilliseconds += chrono::duration<float, milli>(chrono::steady_clock::now() - startTime).count();
+}
+
+// Copies the transforms of all non-static bodies into the snapshot buffer that readers are not using and then publishes it.
+// Readers keep using the other buffer during the next step, it is only written again at the end of the step after that.
+inline void _egJoltWriteTransformSnapshot(EgJoltInstanceInternal* internalInstance)
+{
+	auto& lockInterface = internalInstance->physics_system->GetBodyLockInterfaceNoLock();
+	auto& bodies = internalInstance->snapshotBodies;
+
+	unsigned int readIndex = internalInstance->snapshotIndex.load(memory_order_relaxed);
+	const EgJoltSnapshotBuffer& readBuffer = internalInstance->snapshots[readIndex];
+	EgJoltSnapshotBuffer& buffer = internalInstance->snapshots[1 - readIndex];
+
+	// Destroyed bodies fail the lookup below and are dropped at the next rebuild, so only created bodies need one
+	if (internalInstance->snapshotBodiesChanged)
+	{
+		internalInstance->physics_system->GetBodies(bodies);
+		bodies.erase(remove_if(bodies.begin(), bodies.end(), [&lockInterface](BodyID bodyId)
+		{
+			const Body* body = lockInterface.TryGetBody(bodyId);
+			return !body || body->IsStatic();
+		}), bodies.end());
+		QuickSort(bodies.begin(), bodies.end());
+		internalInstance->snapshotBodiesChanged = false;
+	}
+
+	buffer.bodyIds.clear();
+	buffer.positions.clear();
+	buffer.rotations.clear();
+	for (BodyID bodyId : bodies)
+	{
+		const Body* body = lockInterface.TryGetBody(bodyId);
+		if (!body || body->IsStatic() || !body->IsInBroadPhase()) // Parked pool bodies are not in the world
+			continue;
+
+		buffer.bodyIds.push_back(ConvertBodyId(bodyId));
+		buffer.positions.push_back(ConvertVector3(body->GetPosition()));
+		buffer.rotations.push_back(ConvertQuaternion(body->GetRotation()));
+	}
+	buffer.frame = readBuffer.frame + 1;
+
+	internalInstance->snapshotIndex.store(1 - readIndex, memory_order_release);
+}
+
+// Returns false when no update is in flight
+inline bool _egJoltWaitUpdate(EgJoltInstanceInternal* internalInstance)
+{
+	if (!internalInstance->updateBarrier)
+		return false;
+
+	internalInstance->job_system->WaitForJobs(internalInstance->updateBarrier);
+	internalInstance->job_system->DestroyBarrier(internalInstance->updateBarrier);
+	internalInstance->updateBarrier = nullptr;
+	internalInstance->updateJob = JobHandle();
+	return true;
+}
+
+/* ORIGIN SHIFT */
+// ------------------------------------
+
+// Moves everything by -offset. Bodies keep their activation and contacts, only the broadphase bounds are updated.
+// Recorded lag compensation ticks and the transform snapshots are moved as well, so they stay comparable with the live world.
+inline void _egJoltShiftOrigin(EgJoltInstanceInternal* internalInstance, RVec3Arg offset)
+{
+	auto physicsSystem = internalInstance->physics_system;
+	auto& lockInterface = physicsSystem->GetBodyLockInterfaceNoLock();
+	BodyInterface& bodyInterface = physicsSystem->GetBodyInterfaceNoLock();
+
+	Array<BodyID> bodies;
+	physicsSystem->GetBodies(bodies);
+	for (BodyID bodyId : bodies)
+	{
+		Body* body = lockInterface.TryGetBody(bodyId);
+		if (!body)
+			continue;
+
+		if (body->IsInBroadPhase())
+		{
+			bodyInterface.SetPositionAndRotation(bodyId, body->GetPosition() - offset, body->GetRotation(), EActivation::DontActivate);
+		}
+		else
+		{
+			body->SetPositionAndRotationInternal(body->GetPosition() - offset, body->GetRotation(), false);
+		}
+	}
+
+	// Also puts the inner bodies of the characters back where the characters are
+	for (CharacterVirtual* characterVirtual : internalInstance->characterVirtuals)
+	{
+		characterVirtual->SetPosition(characterVirtual->GetPosition() - offset);
+	}
+
+	Vec3 floatOffset = Vec3(offset);
+	for (EgJoltHistoryTick& historyTick : internalInstance->lagCompensationHistory)
+	{
+		for (EgJoltHistoricalBody& body : historyTick.bodies)
+		{
+			body.transformedShape.mShapePositionCOM -= offset;
+			body.bounds.Translate(-floatOffset);
+		}
+		for (EgJoltHistoryNode& node : historyTick.nodes)
+		{
+			node.bounds.Translate(-floatOffset);
+		}
+	}
+
+	// The published snapshot may be read by other threads, so the shifted copy goes into the other buffer and is published in its place
+	unsigned int readIndex = internalInstance->snapshotIndex.load(memory_order_relaxed);
+	const EgJoltSnapshotBuffer& readBuffer = internalInstance->snapshots[readIndex];
+	EgJoltSnapshotBuffer& buffer = internalInstance->snapshots[1 - readIndex];
+
+	buffer.frame = readBuffer.frame;
+	buffer.bodyIds = readBuffer.bodyIds;
+	buffer.rotations = readBuffer.rotations;
+	buffer.positions.resize(readBuffer.positions.size());
+	for (size_t i = 0; i < readBuffer.positions.size(); i++)
+	{
+		buffer.positions[i] = ConvertVector3(ConvertRVec3(readBuffer.positions[i]) - offset);
+	}
+
+	internalInstance->snapshotIndex.store(1 - readIndex, memory_order_release);
+}
+
+/* STATE HASH */
+// ------------------------------------
+
+static constexpr uint64 cStateHashSeed = 0x84222325CBF29CE4ull;
+static constexpr unsigned int cStateHashBatchSize = 256;
+
+inline uint64 _egJoltMixHash(uint64 hash, uint64 value)
+{
+	hash ^= value * 0x9E3779B97F4A7C15ull;
+	hash = (hash ^ (hash >> 29)) * 0xBF58476D1CE4E5B9ull;
+	return hash ^ (hash >> 32);
+}
+
+inline uint64 _egJoltMixHashWords(uint64 hash, const void* data, size_t size)
+{
+	for (size_t i = 0; i + sizeof(uint64) <= size; i += sizeof(uint64))
+	{
+		uint64 word;
+		memcpy(&word, (const uint8*)data + i, sizeof(word));
+		hash = _egJoltMixHash(hash, word);
+	}
+	return hash;
+}
+
+// Hashes the exact bits of the body's transform and velocities so any divergence between two simulations shows up.
+// The position is hashed at the precision the build simulates with, so hashes only match between builds of the same precision.
+inline uint64 _egJoltHashBodyState(const Body& body)
+{
+	RVec3 position = body.GetCenterOfMassPosition();
+	Real positionValues[4] = { position.GetX(), position.GetY(), position.GetZ(), Real(0) };
+
+	alignas(16) float values[12];
+	body.GetRotation().GetXYZW().StoreFloat4((Float4*)&values[0]);
+	body.GetLinearVelocity().StoreFloat3((Float3*)&values[4]);
+	body.GetAngularVelocity().StoreFloat3((Float3*)&values[7]);
+	values[10] = 0.0f;
+	values[11] = 0.0f;
+
+	uint64 hash = _egJoltMixHash(cStateHashSeed, ConvertBodyId(body.GetID()));
+	hash = _egJoltMixHashWords(hash, positionValues, sizeof(positionValues));
+	hash = _egJoltMixHashWords(hash, values, sizeof(values));
+	return hash;
+}
+
+inline unsigned int _egJoltFindStateHashBody(const Array<BodyID>& bodies, unsigned int bodyId)
+{
+	auto it = lower_bound(bodies.begin(), bodies.end(), ConvertBodyId(bodyId));
+	return it != bodies.end() && *it == ConvertBodyId(bodyId) ? (unsigned int)(it - bodies.begin()) : ~0u;
+}
+
+// Active bodies are hashed in body id order, so two simulations that assign the same ids get the same hash whatever order Jolt keeps them in.
+// Islands are the groups of active bodies that touched each other in the last step. They are named after their lowest body id instead of
+// Jolt's island index, which depends on thread timing.
+inline uint64 _egJoltComputeStateHash(EgJoltInstanceInternal* internalInstance, uint64 layerMask, EgJoltIslandHash* islandHashes, unsigned int islandCapacity, unsigned int* islandCount)
+{
+	PhysicsSystem* physicsSystem = internalInstance->physics_system;
+	auto& lockInterface = physicsSystem->GetBodyLockInterfaceNoLock();
+	auto& bodies = internalInstance->stateHashBodies;
+	auto& bodyHashes = internalInstance->stateHashScratch;
+
+	bodies.clear();
+	const BodyID* activeBodies = physicsSystem->GetActiveBodiesUnsafe(EBodyType::RigidBody);
+	unsigned int activeBodyCount = physicsSystem->GetNumActiveBodies(EBodyType::RigidBody);
+	for (unsigned int i = 0; i < activeBodyCount; i++)
 	{
-		activation = EActivation::Activate;
+		const Body* body = lockInterface.TryGetBody(activeBodies[i]);
+		if (body && (layerMask & (uint64(1) << body->GetObjectLayer())) != 0)
+		{
+			bodies.push_back(activeBodies[i]);
+		}
 	}
-	else
+	QuickSort(bodies.begin(), bodies.end());
+
+	unsigned int count = (unsigned int)bodies.size();
+	bodyHashes.resize(count);
+	_egJoltParallelFor(internalInstance->job_system, count, cStateHashBatchSize, [&](unsigned int start, unsigned int end)
 	{
-		activation = EActivation::DontActivate;
+		for (unsigned int i = start; i < end; i++)
+		{
+			bodyHashes[i] = _egJoltHashBodyState(*lockInterface.TryGetBody(bodies[i]));
+		}
+	});
+
+	uint64 hash = _egJoltMixHash(cStateHashSeed, count);
+	for (uint64 bodyHash : bodyHashes)
+	{
+		hash = _egJoltMixHash(hash, bodyHash);
 	}
 
-	// Create the settings for the body itself. Note that here you can also set other properties like the restitution / friction.
-	BodyCreationSettings bodySettings(shape, ConvertVector3(state->position), *(Quat*)&state->rotation, motionType, layer);
-	auto massProps = bodySettings.GetMassProperties();
-	massProps.mMass = mass;
-	bodySettings.mMassPropertiesOverride = massProps;
-	bodySettings.mMotionQuality = EMotionQuality::LinearCast;
-	bodySettings.mOverrideMassProperties = EOverrideMassProperties::CalculateInertia;
-	bodySettings.mIsSensor = state->flags & EgJolt_BodyFlags_IsSensor;
-	bodySettings.mLinearVelocity = ConvertVector3(state->linearVelocity);
-	bodySettings.mAngularVelocity = ConvertVector3(state->angularVelocity);
-	bodySettings.mAllowSleeping = true;
-	bodySettings.mGravityFactor = state->gravityFactor;
-	bodySettings.mEnhancedInternalEdgeRemoval = true;
+	if (!islandHashes && !islandCount)
+	{
+		return hash;
+	}
+	if (!islandHashes)
+	{
+		islandCapacity = 0;
+	}
 
-	Body* body; // Note that if we run out of bodies this can return nullptr
-	if (bodyId)
+	Array<unsigned int> parents(count);
+	for (unsigned int i = 0; i < count; i++)
 	{
-		body = bodyInterface.CreateBodyWithID(*bodyId, bodySettings);
+		parents[i] = i;
 	}
-	else
+	for (uint64 key : internalInstance->contactPairs)
 	{
-		body = bodyInterface.CreateBody(bodySettings);
+		unsigned int index1 = _egJoltFindStateHashBody(bodies, (unsigned int)(key >> 32));
+		unsigned int index2 = _egJoltFindStateHashBody(bodies, (unsigned int)key);
+		if (index1 != ~0u && index2 != ~0u)
+		{
+			unsigned int root1 = _egJoltFindGroup(parents, index1);
+			unsigned int root2 = _egJoltFindGroup(parents, index2);
+			parents[max(root1, root2)] = min(root1, root2);
+		}
 	}
 
-	// Add it to the world
-	bodyInterface.AddBody(body->GetID(), activation);
-	bodyInterface.SetUserData(body->GetID(), userData);
+	// Roots are always the lowest index of their island, so islands come out sorted by their lowest body id
+	Array<unsigned int> islandIndices(count, ~0u);
+	unsigned int islands = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int root = _egJoltFindGroup(parents, i);
+		if (islandIndices[root] == ~0u)
+		{
+			islandIndices[root] = islands++;
+			if (islandIndices[root] < islandCapacity)
+			{
+				EgJoltIslandHash& islandHash = islandHashes[islandIndices[root]];
+				islandHash.bodyId = ConvertBodyId(bodies[i]);
+				islandHash.bodyCount = 0;
+				islandHash.hash = cStateHashSeed;
+			}
+		}
 
-	return *(unsigned int*)(&body->GetID());
+		unsigned int islandIndex = islandIndices[root];
+		if (islandIndex < islandCapacity)
+		{
+			EgJoltIslandHash& islandHash = islandHashes[islandIndex];
+			islandHash.bodyCount++;
+			islandHash.hash = _egJoltMixHash(islandHash.hash, bodyHashes[i]);
+		}
+	}
+
+	if (islandCount)
+	{
+		*islandCount = islands;
+	}
+	return hash;
 }
 
-inline unsigned int _egJoltAddBody2(EgJoltInstance instance, EMotionType motionType, ObjectLayer layer, float mass, Shape* shape, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state)
+// Queries smaller than this are answered on the calling thread, larger batches are split over the job system in chunks of this size.
+static constexpr unsigned int cQueryBatchSize = 32;
+
+inline bool _egJoltCastRay(EgJoltInstanceInternal* internalInstance, const EgJoltRayCast& rayCast, EgJoltRayCastResult& result)
 {
-	BodyInterface& bodyInterface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
+	result = {};
+	result.bodyId = BodyID::cInvalidBodyID;
 
-	EActivation activation = {};
-	if (state->flags & EgJolt_BodyFlags_IsActive)
+	RRayCast ray(ConvertRVec3(rayCast.origin), Vec3(rayCast.direction.x, rayCast.direction.y, rayCast.direction.z) * rayCast.maxDistance);
+	RayCastSettings settings;
+
+	EgJoltBroadPhaseLayerMaskFilter broadPhaseFilter(internalInstance->layerMatrix.GetBroadPhaseMask(rayCast.layerMask));
+	EgJoltLayerMaskFilter layerFilter(rayCast.layerMask);
+	IgnoreSingleBodyFilter bodyFilter(ConvertBodyId(rayCast.ignoreBodyId));
+
+	RayCastResult hit;
+	const NarrowPhaseQuery& query = internalInstance->physics_system->GetNarrowPhaseQueryNoLock();
+	if (rayCast.flags & EgJolt_QueryFlags_AnyHit)
 	{
-		activation = EActivation::Activate;
+		AnyHitCollisionCollector<CastRayCollector> collector;
+		query.CastRay(ray, settings, collector, broadPhaseFilter, layerFilter, bodyFilter);
+		if (!collector.HadHit())
+			return false;
+		hit = collector.mHit;
 	}
 	else
 	{
-		activation = EActivation::DontActivate;
+		ClosestHitCollisionCollector<CastRayCollector> collector;
+		query.CastRay(ray, settings, collector, broadPhaseFilter, layerFilter, bodyFilter);
+		if (!collector.HadHit())
+			return false;
+		hit = collector.mHit;
 	}
 
-	// Create the settings for the body itself. Note that here you can also set other properties like the restitution / friction.
-	BodyCreationSettings bodySettings(shape, ConvertVector3(state->position), *(Quat*)&state->rotation, motionType, layer);
-	auto massProps = bodySettings.GetMassProperties();
-	massProps.mMass = mass;
-	bodySettings.mMassPropertiesOverride = massProps;
-	bodySettings.mMotionQuality = EMotionQuality::LinearCast;
-	bodySettings.mOverrideMassProperties = EOverrideMassProperties::CalculateInertia;
-	bodySettings.mIsSensor = state->flags & EgJolt_BodyFlags_IsSensor;
-	bodySettings.mLinearVelocity = ConvertVector3(state->linearVelocity);
-	bodySettings.mAngularVelocity = ConvertVector3(state->angularVelocity);
-	bodySettings.mAllowSleeping = true;
-	bodySettings.mGravityFactor = state->gravityFactor;
-	bodySettings.mEnhancedInternalEdgeRemoval = true;
+	RVec3 position = ray.GetPointOnRay(hit.mFraction);
+	auto body = internalInstance->physics_system->GetBodyLockInterfaceNoLock().TryGetBody(hit.mBodyID);
 
-	Body* body; // Note that if we run out of bodies this can return nullptr
-	if (bodyId)
+	result.bodyId = ConvertBodyId(hit.mBodyID);
+	result.userData = body->GetUserData();
+	result.position = ConvertVector3(position);
+	Vec3 normal = body->GetWorldSpaceSurfaceNormal(hit.mSubShapeID2, position);
+	result.normal = { normal.GetX(), normal.GetY(), normal.GetZ() };
+	result.distance = hit.mFraction * rayCast.maxDistance;
+	result.hasHit = true;
+	return true;
+}
+
+inline bool _egJoltCastShape(EgJoltInstanceInternal* internalInstance, const EgJoltShapeCast& shapeCast, EgJoltShapeCastResult& result)
+{
+	result = {};
+	result.bodyId = BodyID::cInvalidBodyID;
+
+	// Cast relative to the start position so the results keep their precision far from the origin
+	RVec3 baseOffset = ConvertRVec3(shapeCast.position);
+	Vec3 direction = Vec3(shapeCast.direction.x, shapeCast.direction.y, shapeCast.direction.z) * shapeCast.maxDistance;
+	RShapeCast cast = RShapeCast::sFromWorldTransform((const Shape*)shapeCast.shape.internal, Vec3::sOne(), RMat44::sRotationTranslation(ConvertQuaternion(shapeCast.rotation), baseOffset), direction);
+	ShapeCastSettings settings;
+
+	EgJoltBroadPhaseLayerMaskFilter broadPhaseFilter(internalInstance->layerMatrix.GetBroadPhaseMask(shapeCast.layerMask));
+	EgJoltLayerMaskFilter layerFilter(shapeCast.layerMask);
+	IgnoreSingleBodyFilter bodyFilter(ConvertBodyId(shapeCast.ignoreBodyId));
+
+	ShapeCastResult hit;
+	const NarrowPhaseQuery& query = internalInstance->physics_system->GetNarrowPhaseQueryNoLock();
+	if (shapeCast.flags & EgJolt_QueryFlags_AnyHit)
 	{
-		body = bodyInterface.CreateBodyWithID(*bodyId, bodySettings);
+		AnyHitCollisionCollector<CastShapeCollector> collector;
+		query.CastShape(cast, settings, baseOffset, collector, broadPhaseFilter, layerFilter, bodyFilter);
+		if (!collector.HadHit())
+			return false;
+		hit = collector.mHit;
 	}
 	else
 	{
-		body = bodyInterface.CreateBody(bodySettings);
+		ClosestHitCollisionCollector<CastShapeCollector> collector;
+		query.CastShape(cast, settings, baseOffset, collector, broadPhaseFilter, layerFilter, bodyFilter);
+		if (!collector.HadHit())
+			return false;
+		hit = collector.mHit;
 	}
 
-	// Add it to the world
-	bodyInterface.AddBody(body->GetID(), activation);
-	bodyInterface.SetUserData(body->GetID(), userData);
+	auto body = internalInstance->physics_system->GetBodyLockInterfaceNoLock().TryGetBody(hit.mBodyID2);
 
+	result.bodyId = ConvertBodyId(hit.mBodyID2);
+	result.userData = body->GetUserData();
+	result.position = ConvertVector3(baseOffset + hit.mContactPointOn2);
+	Vec3 normal = -hit.mPenetrationAxis.NormalizedOr(Vec3::sZero());
+	result.normal = { normal.GetX(), normal.GetY(), normal.GetZ() };
+	result.distance = hit.mFraction * shapeCast.maxDistance;
+	result.penetrationDepth = hit.mPenetrationDepth;
+	result.hasHit = true;
 	return true;
 }
 
-inline unsigned int _egJoltAddBodyBox(EgJoltInstance instance, EgJoltVector3 scale, EMotionType motionType, ObjectLayer layer, float density, float mass, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state)
-{
-	BoxShapeSettings settings(Vec3(scale.x, scale.y, scale.z), 0);
-	settings.mDensity = density;
-	return _egJoltAddBody(instance, motionType, layer, mass, settings.Create(), userData, bodyId, state);
-}
+/* OVERLAP QUERIES */
+// ------------------------------------
 
-inline unsigned int _egJoltAddBodySphere(EgJoltInstance instance, float radius, EMotionType motionType, ObjectLayer layer, float density, float mass, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state)
+/// Collects the bodies whose bounds overlap the query volume
+class EgJoltBroadPhaseOverlapCollector final : public CollideShapeBodyCollector
 {
-	SphereShapeSettings settings(radius);
-	settings.mDensity = density;
-	return _egJoltAddBody(instance, motionType, layer, mass, settings.Create(), userData, bodyId, state);
-}
+public:
+	EgJoltBroadPhaseOverlapCollector(const BodyLockInterfaceNoLock& lockInterface, Array<EgJoltOverlapHit>& hits) : lockInterface(lockInterface), hits(hits) {}
+
+	virtual void AddHit(const BodyID& inBodyID) override
+	{
+		const Body* body = lockInterface.TryGetBody(inBodyID);
+		hits.push_back({ ConvertBodyId(inBodyID), body->GetUserData() });
+	}
+
+private:
+	const BodyLockInterfaceNoLock& lockInterface;
+	Array<EgJoltOverlapHit>& hits;
+};
 
-inline unsigned int _egJoltAddBodyMesh(EgJoltInstance instance, EgJoltVector3* vertices, int vertexCount, unsigned int* indices, int indexCount, EMotionType motionType, ObjectLayer layer, float mass, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state)
+/// Collects the bodies whose shapes overlap the query shape. A body that touches the query with several sub shapes is only collected once.
+class EgJoltOverlapCollector final : public CollideShapeCollector
 {
-	auto vertexListCount = vertexCount;
-	auto vertexList = VertexList(vertexListCount);
-	auto indexListCount = indexCount / 3;
-	auto indexList = IndexedTriangleList(indexListCount);
+public:
+	explicit EgJoltOverlapCollector(Array<EgJoltOverlapHit>& hits) : hits(hits) {}
 
-	for (int i = 0; i < vertexListCount; i++)
+	virtual void OnBody(const Body& inBody) override
 	{
-		auto v = vertices[i];
-		vertexList[i] = Float3(v.x, v.y, v.z);
+		userData = inBody.GetUserData();
 	}
 
-	for (int i = 0; i < indexListCount; i++)
+	virtual void AddHit(const CollideShapeResult& inResult) override
 	{
-		indexList[i] = IndexedTriangle(indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]);
+		unsigned int bodyId = ConvertBodyId(inResult.mBodyID2);
+		if (!hits.empty() && hits.back().bodyId == bodyId)
+			return;
+
+		hits.push_back({ bodyId, userData });
 	}
 
-	MeshShapeSettings settings(std::move(vertexList), std::move(indexList));
-	return _egJoltAddBody(instance, motionType, layer, mass, settings.Create(), userData, bodyId, state);
+private:
+	Array<EgJoltOverlapHit>& hits;
+	unsigned long long userData = 0;
+};
+
+inline void _egJoltOverlapShape(EgJoltInstanceInternal* internalInstance, const Shape& shape, RVec3Arg position, QuatArg rotation, unsigned long long layerMask, Array<EgJoltOverlapHit>& hits)
+{
+	EgJoltBroadPhaseLayerMaskFilter broadPhaseFilter(internalInstance->layerMatrix.GetBroadPhaseMask(layerMask));
+	EgJoltLayerMaskFilter layerFilter(layerMask);
+
+	EgJoltOverlapCollector collector(hits);
+	internalInstance->physics_system->GetNarrowPhaseQueryNoLock().CollideShape(&shape, Vec3::sOne(), RMat44::sRotationTranslation(rotation, position), CollideShapeSettings(), position, collector, broadPhaseFilter, layerFilter);
 }
 
-inline unsigned int _egJoltAddStaticBodyCompoundMesh(EgJoltInstance instance, EgJoltCompoundMesh compoundMesh, EMotionType motionType, ObjectLayer layer, float mass, unsigned long long userData, BodyID* bodyId, EgJoltBodyState* state)
+inline void _egJoltOverlapSphere(EgJoltInstanceInternal* internalInstance, const EgJoltSphereOverlap& overlap, Array<EgJoltOverlapHit>& hits)
 {
-	Ref<StaticCompoundShapeSettings> compoundShapeSettings = new StaticCompoundShapeSettings;
+	if (overlap.flags & EgJolt_QueryFlags_BoundsOnly)
+	{
+		EgJoltBroadPhaseLayerMaskFilter broadPhaseFilter(internalInstance->layerMatrix.GetBroadPhaseMask(overlap.layerMask));
+		EgJoltLayerMaskFilter layerFilter(overlap.layerMask);
 
-	for (unsigned int k = 0; k < compoundMesh.meshCount; k++)
+		EgJoltBroadPhaseOverlapCollector collector(internalInstance->physics_system->GetBodyLockInterfaceNoLock(), hits);
+		internalInstance->physics_system->GetBroadPhaseQuery().CollideSphere(Vec3(overlap.center.x, overlap.center.y, overlap.center.z), overlap.radius, collector, broadPhaseFilter, layerFilter);
+		return;
+	}
+
+	SphereShape sphere(overlap.radius);
+	sphere.SetEmbedded();
+	_egJoltOverlapShape(internalInstance, sphere, ConvertRVec3(overlap.center), Quat::sIdentity(), overlap.layerMask, hits);
+}
+
+inline void _egJoltOverlapBox(EgJoltInstanceInternal* internalInstance, const EgJoltBoxOverlap& overlap, Array<EgJoltOverlapHit>& hits)
+{
+	Vec3 halfExtents(overlap.halfExtents.x, overlap.halfExtents.y, overlap.halfExtents.z);
+	Quat rotation = ConvertQuaternion(overlap.rotation);
+
+	if (overlap.flags & EgJolt_QueryFlags_BoundsOnly)
 	{
-		auto mesh = compoundMesh.meshes[k];
-		auto vertexCount = mesh.vertexCount;
-		auto vertices = mesh.vertices;
-		auto indexCount = mesh.indexCount;
-		auto indices = mesh.indices;
+		EgJoltBroadPhaseLayerMaskFilter broadPhaseFilter(internalInstance->layerMatrix.GetBroadPhaseMask(overlap.layerMask));
+		EgJoltLayerMaskFilter layerFilter(overlap.layerMask);
 
-		auto vertexListCount = vertexCount;
-		auto vertexList = VertexList(vertexListCount);
-		auto indexListCount = indexCount / 3;
-		auto indexList = IndexedTriangleList(indexListCount);
+		OrientedBox box(Mat44::sRotationTranslation(rotation, Vec3(overlap.center.x, overlap.center.y, overlap.center.z)), halfExtents);
+		EgJoltBroadPhaseOverlapCollector collector(internalInstance->physics_system->GetBodyLockInterfaceNoLock(), hits);
+		internalInstance->physics_system->GetBroadPhaseQuery().CollideOrientedBox(box, collector, broadPhaseFilter, layerFilter);
+		return;
+	}
 
-		for (unsigned int i = 0; i < vertexListCount; i++)
+	// The convex radius may not be larger than the box
+	BoxShape box(halfExtents, min(cDefaultConvexRadius, halfExtents.ReduceMin()));
+	box.SetEmbedded();
+	_egJoltOverlapShape(internalInstance, box, ConvertRVec3(overlap.center), rotation, overlap.layerMask, hits);
+}
+
+// Runs the queries over the job system into per query arrays and then packs them into hits, sorted by body id so the order does not depend on the broadphase.
+// The per query arrays belong to the calling thread rather than the instance, so threads can run overlap batches on one instance at the same time.
+template <typename F>
+inline unsigned int _egJoltOverlap(EgJoltInstanceInternal* internalInstance, unsigned int count, EgJoltOverlapHit* hits, unsigned int hitCapacity, unsigned int* hitOffsets, const F& overlap)
+{
+	static thread_local Array<Array<EgJoltOverlapHit>> queryHits;
+	if (queryHits.size() < count)
+	{
+		queryHits.resize(count);
+	}
+
+	_egJoltParallelFor(internalInstance->job_system, count, cQueryBatchSize, [&](unsigned int start, unsigned int end)
+	{
+		for (unsigned int i = start; i < end; i++)
 		{
-			auto v = vertices[i];
-			vertexList[i] = Float3(v.x, v.y, v.z);
+			queryHits[i].clear();
+			overlap(i, queryHits[i]);
+			QuickSort(queryHits[i].begin(), queryHits[i].end(), [](const EgJoltOverlapHit& a, const EgJoltOverlapHit& b) { return a.bodyId < b.bodyId; });
 		}
+	});
 
-		for (unsigned int i = 0; i < indexListCount; i++)
+	unsigned int hitCount = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		hitOffsets[i] = hitCount;
+		for (const EgJoltOverlapHit& hit : queryHits[i])
 		{
-			indexList[i] = IndexedTriangle(indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]);
+			if (hitCount < hitCapacity)
+			{
+				hits[hitCount] = hit;
+			}
+			hitCount++;
 		}
+	}
+	hitOffsets[count] = hitCount;
+	return hitCount;
+}
 
-		MeshShapeSettings settings(std::move(vertexList), std::move(indexList));
-		compoundShapeSettings->AddShape(Vec3Arg::sZero(), QuatArg::sIdentity(), settings.Create().Get());	
+/* LAG COMPENSATION */
+// ------------------------------------
+
+// Leaves stop splitting at this many bodies, testing a handful of bounds is cheaper than another level of nodes
+static constexpr unsigned int cHistoryLeafSize = 4;
+static constexpr unsigned int cHistoryMaxDepth = 64;
+
+// Splits the bodies at the median of their centers along the axis they are spread the most, so the tree depth stays log2 of the body count.
+inline void _egJoltBuildHistoryNodes(EgJoltHistoryTick& historyTick, unsigned int firstBody, unsigned int bodyCount)
+{
+	unsigned int nodeIndex = (unsigned int)historyTick.nodes.size();
+	historyTick.nodes.push_back({ AABox(), firstBody, bodyCount, 0 });
+
+	AABox bounds;
+	AABox centers;
+	for (unsigned int i = firstBody; i < firstBody + bodyCount; i++)
+	{
+		bounds.Encapsulate(historyTick.bodies[i].bounds);
+		centers.Encapsulate(historyTick.bodies[i].bounds.GetCenter());
 	}
+	historyTick.nodes[nodeIndex].bounds = bounds;
+
+	if (bodyCount <= cHistoryLeafSize)
+		return;
+
+	int axis = centers.GetExtent().GetHighestComponentIndex();
+	EgJoltHistoricalBody* begin = historyTick.bodies.data() + firstBody;
+	QuickSort(begin, begin + bodyCount, [axis](const EgJoltHistoricalBody& a, const EgJoltHistoricalBody& b)
+	{
+		return a.bounds.GetCenter()[axis] < b.bounds.GetCenter()[axis];
+	});
 
-	return _egJoltAddBody(instance, motionType, layer, mass, compoundShapeSettings->Create(), userData, bodyId, state);
+	unsigned int leftCount = bodyCount / 2;
+	_egJoltBuildHistoryNodes(historyTick, firstBody, leftCount);
+	unsigned int rightChild = (unsigned int)historyTick.nodes.size();
+	_egJoltBuildHistoryNodes(historyTick, firstBody + leftCount, bodyCount - leftCount);
+
+	EgJoltHistoryNode& node = historyTick.nodes[nodeIndex];
+	node.bodyCount = 0;
+	node.rightChild = rightChild;
 }
 
-CharacterVirtual* GetInternalCharacterVirtual(EgJoltCharacterVirtual egCharacter)
+// Bodies that were removed or parked in a body pool are left out of the tick.
+inline bool _egJoltRecordHistoryTick(EgJoltInstanceInternal* internalInstance, unsigned int tick)
 {
-	return (CharacterVirtual*)egCharacter.internal;
+	auto& history = internalInstance->lagCompensationHistory;
+	if (history.empty())
+		return false;
+
+	// The tick's storage is kept between records, so once the ring is warm this does not allocate.
+	EgJoltHistoryTick& historyTick = history[tick % history.size()];
+	historyTick.bodies.clear();
+	historyTick.nodes.clear();
+
+	auto& lockInterface = internalInstance->physics_system->GetBodyLockInterfaceNoLock();
+	for (BodyID bodyId : internalInstance->lagCompensatedBodies)
+	{
+		const Body* body = lockInterface.TryGetBody(bodyId);
+		if (!body || !body->IsInBroadPhase())
+			continue;
+
+		historyTick.bodies.push_back({ body->GetTransformedShape(), body->GetWorldSpaceBounds(), body->GetUserData(), (unsigned char)body->GetObjectLayer() });
+	}
+
+	if (!historyTick.bodies.empty())
+	{
+		_egJoltBuildHistoryNodes(historyTick, 0, (unsigned int)historyTick.bodies.size());
+	}
+
+	historyTick.tick = tick;
+	historyTick.isValid = true;
+	return true;
 }
 
-Character* GetInternalCharacter(EgJoltCharacter egCharacter)
+inline const EgJoltHistoryTick* _egJoltFindHistoryTick(EgJoltInstanceInternal* internalInstance, unsigned int tick)
 {
-	return (Character*)egCharacter.internal;
+	auto& history = internalInstance->lagCompensationHistory;
+	if (history.empty())
+		return nullptr;
+
+	const EgJoltHistoryTick& historyTick = history[tick % history.size()];
+	if (!historyTick.isValid || historyTick.tick != tick)
+		return nullptr;
+
+	return &historyTick;
 }
 
-inline EgJoltCharacterVirtual _egJoltCreateCharacterVirtual(EgJoltInstance instance, EgJoltCharacterSettings& settings, EgJoltVector3 position)
+// Same results as _egJoltCastRay, but against the poses of the lag compensated bodies at a recorded tick instead of the live world.
+inline bool _egJoltCastRayAtTick(const EgJoltHistoryTick& historyTick, const EgJoltRayCast& rayCast, EgJoltRayCastResult& result)
 {
-	auto internal = GetInternalInstance(instance);
-	auto physics = internal->physics_system;
+	result = {};
+	result.bodyId = BodyID::cInvalidBodyID;
 
-	//mStandingShape = RotatedTranslatedShapeSettings(Vec3(0, 0.5f * cCharacterHeightStanding + cCharacterRadiusStanding, 0), Quat::sIdentity(), new CapsuleShape(0.5f * cCharacterHeightStanding, cCharacterRadiusStanding)).Create().Get();
-	auto rot = Quat::sRotation(Vec3::sAxisX(), DegreesToRadians(90));
-	Ref<Shape> standingShape = RotatedTranslatedShapeSettings(Vec3(0, 0, 0.5f * settings.standingHeight + settings.standingRadius), rot, new CapsuleShape(0.5f * settings.standingHeight, settings.standingRadius)).Create().Get();
+	if (historyTick.nodes.empty())
+		return false;
 
-	Ref<CharacterVirtualSettings> virtualSettings = new CharacterVirtualSettings();
-	virtualSettings->mMaxSlopeAngle = settings.maxSlopeAngle;
-	virtualSettings->mMaxStrength = settings.maxStrength;
-	virtualSettings->mShape = standingShape;
-	virtualSettings->mBackFaceMode = EBackFaceMode::IgnoreBackFaces;
-	virtualSettings->mCharacterPadding = settings.padding;
-	virtualSettings->mPenetrationRecoverySpeed = settings.penetrationRecoverySpeed;
-	virtualSettings->mPredictiveContactDistance = settings.predictiveContactDistance;
-	virtualSettings->mSupportingVolume = Plane(Vec3::sAxisZ(), -settings.standingRadius); // Accept contacts that touch the lower sphere of the capsule
-	virtualSettings->mUp = Vec3::sAxisZ();
-	virtualSettings->mMass = settings.mass;
-	virtualSettings->mInnerBodyLayer = settings.layer;
-	virtualSettings->mEnhancedInternalEdgeRemoval = true;
+	RRayCast ray(ConvertRVec3(rayCast.origin), Vec3(rayCast.direction.x, rayCast.direction.y, rayCast.direction.z) * rayCast.maxDistance);
+	Vec3 origin = Vec3(ray.mOrigin);
+	RayInvDirection invDirection(ray.mDirection);
+	bool anyHit = rayCast.flags & EgJolt_QueryFlags_AnyHit;
 
-	auto jCharacterVirtual = new CharacterVirtual(virtualSettings, ConvertVector3(position), Quat::sIdentity(), physics);
-	jCharacterVirtual->SetListener(internal->characterContactListener);
+	RayCastResult hit;
+	const EgJoltHistoricalBody* hitBody = nullptr;
 
-	EgJoltCharacterVirtual character = {};
-	character.internal = jCharacterVirtual;
-	return character;
-}
+	unsigned int stack[cHistoryMaxDepth];
+	unsigned int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const EgJoltHistoryNode& node = historyTick.nodes[stack[--stackSize]];
+		if (RayAABox(origin, invDirection, node.bounds.mMin, node.bounds.mMax) >= hit.mFraction)
+			continue;
 
-inline EgJoltCharacter _egJoltCreateCharacter(EgJoltInstance instance, EgJoltCharacterSettings& settings, EgJoltVector3 position, ObjectLayer layer, unsigned long long userData)
-{
-	auto internal = GetInternalInstance(instance);
-	auto physics = internal->physics_system;
+		if (node.bodyCount == 0)
+		{
+			unsigned int nodeIndex = (unsigned int)(&node - historyTick.nodes.data());
+			stack[stackSize++] = node.rightChild;
+			stack[stackSize++] = nodeIndex + 1;
+			continue;
+		}
 
-	auto rot = Quat::sRotation(Vec3::sAxisX(), DegreesToRadians(90));
-	Ref<Shape> standingShape = RotatedTranslatedShapeSettings(Vec3(0, 0, 0.5f * settings.standingHeight + settings.standingRadius), rot, new CapsuleShape(0.5f * settings.standingHeight, settings.standingRadius)).Create().Get();
+		for (unsigned int i = node.firstBody; i < node.firstBody + node.bodyCount; i++)
+		{
+			const EgJoltHistoricalBody& body = historyTick.bodies[i];
+			if ((rayCast.layerMask & (uint64(1) << body.layer)) == 0 || ConvertBodyId(body.transformedShape.mBodyID) == rayCast.ignoreBodyId)
+				continue;
 
-	Ref<CharacterSettings> jSettings = new CharacterSettings();
-	jSettings->mMass = settings.mass;
-	jSettings->mMaxSlopeAngle = settings.maxSlopeAngle;
-	jSettings->mShape = standingShape;
-	jSettings->mLayer = layer;
-	jSettings->mUp = Vec3::sAxisZ();
-	jSettings->mSupportingVolume = Plane(Vec3::sAxisZ(), -settings.standingRadius); // Accept contacts that touch the lower sphere of the capsule
-	jSettings->mEnhancedInternalEdgeRemoval = true;
+			if (body.transformedShape.CastRay(ray, hit))
+			{
+				hitBody = &body;
+			}
+		}
 
-	auto jCharacter = new Character(jSettings, ConvertVector3(position), Quat::sIdentity(), userData, physics);
-	jCharacter->AddToPhysicsSystem(EActivation::Activate);
+		if (hitBody && anyHit)
+			break;
+	}
 
-	EgJoltCharacter character = {};
-	character.internal = jCharacter;
-	return character;
+	if (!hitBody)
+		return false;
+
+	RVec3 position = ray.GetPointOnRay(hit.mFraction);
+
+	result.bodyId = ConvertBodyId(hit.mBodyID);
+	result.userData = hitBody->userData;
+	result.position = ConvertVector3(position);
+	Vec3 normal = hitBody->transformedShape.GetWorldSpaceSurfaceNormal(hit.mSubShapeID2, position);
+	result.normal = { normal.GetX(), normal.GetY(), normal.GetZ() };
+	result.distance = hit.mFraction * rayCast.maxDistance;
+	result.hasHit = true;
+	return true;
 }
 
 extern "C" {
@@ -595,6 +3707,12 @@ extern "C" {
 		return 65536;
 	}
 
+	EG_EXPORT unsigned int egJoltGetMaxLayers()
+	{
+		// Layer collision rules are stored as one 64-bit mask per layer.
+		return EgJoltLayerMatrix::MaxLayers;
+	}
+
 	EG_EXPORT unsigned int egJoltGetMaxContactConstraints()
 	{
 		// This is the maximum size of the contact constraint buffer. If more contacts (collisions between bodies) are detected than this
@@ -605,8 +3723,9 @@ extern "C" {
 
 	EG_EXPORT void egJoltSharedInit()
 	{
-		// Register allocation hook
+		// Register allocation hook, with counters on top of the default allocator
 		RegisterDefaultAllocator();
+		RegisterTrackedAllocator();
 
 		// Install callbacks
 		Trace = TraceImpl;
@@ -615,65 +3734,188 @@ extern "C" {
 		// Create a factory
 		Factory::sInstance = new Factory();
 
-		// Register all Jolt physics types
-		RegisterTypes();
+		// Register all Jolt physics types
+		RegisterTypes();
+
+		s_defaultJobSystem = GetInternalJobSystem(egJoltCreateJobSystem(-1, 0, cDefaultJobSystemMaxInstances));
+		s_shapeRegistry = new EgJoltShapeRegistry;
+	}
+
+	EG_EXPORT void egJoltSharedDestroy()
+	{
+		delete s_shapeRegistry;
+		s_shapeRegistry = nullptr;
+
+		delete s_defaultJobSystem;
+		s_defaultJobSystem = nullptr;
+
+		// Unregisters all types with the factory and cleans up the default material
+		UnregisterTypes();
+
+		// Destroy the factory
+		delete Factory::sInstance;
+		Factory::sInstance = nullptr;
+	}
+
+	EG_EXPORT EgJoltInstanceSettings egJoltGetDefaultInstanceSettings()
+	{
+		PhysicsSettings physicsSettings;
+
+		EgJoltInstanceSettings settings = {};
+		settings.maxBodies = egJoltGetMaxBodies();
+		// 0 lets Jolt pick the number of mutexes that protect rigid bodies from concurrent access.
+		settings.numBodyMutexes = 0;
+		settings.maxBodyPairs = egJoltGetMaxBodyPairs();
+		settings.maxContactConstraints = egJoltGetMaxContactConstraints();
+		// 10 MB is a typical size for the allocations made during a physics update.
+		settings.tempAllocatorSize = 10 * 1024 * 1024;
+		settings.threadCount = 0;
+		settings.collisionSteps = 1;
+		settings.numVelocitySteps = physicsSettings.mNumVelocitySteps;
+		settings.numPositionSteps = physicsSettings.mNumPositionSteps;
+		settings.baumgarte = physicsSettings.mBaumgarte;
+		settings.speculativeContactDistance = physicsSettings.mSpeculativeContactDistance;
+		settings.penetrationSlop = physicsSettings.mPenetrationSlop;
+		settings.timeBeforeSleep = physicsSettings.mTimeBeforeSleep;
+		settings.pointVelocitySleepThreshold = physicsSettings.mPointVelocitySleepThreshold;
+		settings.allowSleeping = physicsSettings.mAllowSleeping;
+		settings.deterministicSimulation = true;
+		return settings;
+	}
+
+	/* JOB SYSTEM */
+
+	EG_EXPORT EgJoltJobSystem egJoltCreateJobSystem(int threadCount, unsigned long long affinityMask, unsigned int maxInstances)
+	{
+		// Every instance stepping on the job system can have a full physics step worth of jobs and barriers in flight.
+		maxInstances = max(maxInstances, 1u);
+
+		EgJoltJobSystem jobSystem = {};
+		jobSystem.internal = new EgJoltJobSystemImpl(cMaxPhysicsJobs * maxInstances, cMaxPhysicsBarriers * maxInstances, threadCount, affinityMask);
+		return jobSystem;
+	}
+
+	EG_EXPORT void egJoltDestroyJobSystem(EgJoltJobSystem jobSystem)
+	{
+		auto internalJobSystem = GetInternalJobSystem(jobSystem);
+		assert(internalJobSystem != s_defaultJobSystem);
+		delete internalJobSystem;
+	}
+
+	EG_EXPORT EgJoltJobSystem egJoltGetDefaultJobSystem()
+	{
+		EgJoltJobSystem jobSystem = {};
+		jobSystem.internal = s_defaultJobSystem;
+		return jobSystem;
 	}
 
-	EG_EXPORT void egJoltSharedDestroy()
+	EG_EXPORT int egJoltJobSystemGetMaxConcurrency(EgJoltJobSystem jobSystem)
 	{
-		// Unregisters all types with the factory and cleans up the default material
-		UnregisterTypes();
+		return GetInternalJobSystem(jobSystem)->GetMaxConcurrency();
+	}
 
-		// Destroy the factory
-		delete Factory::sInstance;
-		Factory::sInstance = nullptr;
+	EG_EXPORT void egJoltJobSystemParallelFor(EgJoltJobSystem jobSystem, unsigned int count, unsigned int batchSize, void(*callback)(void* userData, unsigned int start, unsigned int end), void* userData)
+	{
+		_egJoltParallelFor(GetInternalJobSystem(jobSystem), count, batchSize, [callback, userData](unsigned int start, unsigned int end)
+		{
+			callback(userData, start, end);
+		});
+	}
+
+	EG_EXPORT void egJoltSetJobSystem(EgJoltInstance instance, EgJoltJobSystem jobSystem)
+	{
+		GetInternalInstance(instance)->job_system = GetInternalJobSystem(jobSystem);
 	}
 
 	EG_EXPORT EgJoltInstance egJoltCreateInstance(
 		unsigned char maxNumberOfLayers,
 		void(*callbackContactAdded)(EgJoltContactArgs), 
 		void(*callbackContactPersisted)(EgJoltContactArgs),
-		bool(*callbackShouldCollide)(unsigned char layer1, unsigned char layer2)
+		bool(*callbackShouldCollide)(unsigned char layer1, unsigned char layer2),
+		const EgJoltInstanceSettings* instanceSettings
 	)
 	{
-		// We need a temp allocator for temporary allocations during the physics update. We're
-		// pre-allocating 10 MB to avoid having to do allocations during the physics update.
-		// B.t.w. 10 MB is way too much for this example but it is a typical value you can use.
-		// If you don't want to pre-allocate you can also use TempAllocatorMalloc to fall back to
-		// malloc / free.
-		TempAllocatorImpl* temp_allocator = new TempAllocatorImpl(10 * 1024 * 1024);
+		EgJoltInstanceSettings defaultSettings = egJoltGetDefaultInstanceSettings();
+		if (!instanceSettings)
+		{
+			instanceSettings = &defaultSettings;
+		}
+
+		// We need a temp allocator for temporary allocations during the physics update. It is
+		// pre-allocated to avoid having to do allocations during the physics update.
+		EgJoltTempAllocator* temp_allocator = new EgJoltTempAllocator(instanceSettings->tempAllocatorSize);
+
+		auto internalInstance = new EgJoltInstanceInternal();
 
-		// We need a job system that will execute physics jobs on multiple threads. Typically
-		// you would implement the JobSystem interface yourself and let Jolt Physics run on top
-		// of your own job scheduler. JobSystemThreadPool is an example implementation.
-		JobSystemThreadPool* job_system = new JobSystemThreadPool(cMaxPhysicsJobs, cMaxPhysicsBarriers, thread::hardware_concurrency() - 1);
+		// All instances step on the shared job system so that a client and a server world in the same process do not
+		// oversubscribe the cores with a thread pool each. A thread count gives the instance a job system of its own instead.
+		JobSystem* job_system;
+		if (instanceSettings->threadCount > 0)
+		{
+			internalInstance->ownedJobSystem = GetInternalJobSystem(egJoltCreateJobSystem(instanceSettings->threadCount, 0, 1));
+			job_system = internalInstance->ownedJobSystem;
+		}
+		else
+		{
+			JPH_ASSERT(s_defaultJobSystem != nullptr);
+			job_system = s_defaultJobSystem;
+		}
 
-		const uint cMaxBodies = egJoltGetMaxBodies();
-		// This determines how many mutexes to allocate to protect rigid bodies from concurrent access. Set it to 0 for the default settings.
-		const uint cNumBodyMutexes = 0;
-		const uint cMaxBodyPairs = egJoltGetMaxBodyPairs();
-		const uint cMaxContactConstraints = egJoltGetMaxContactConstraints();
+		const uint cMaxBodies = instanceSettings->maxBodies;
+		const uint cNumBodyMutexes = instanceSettings->numBodyMutexes;
+		const uint cMaxBodyPairs = instanceSettings->maxBodyPairs;
+		const uint cMaxContactConstraints = instanceSettings->maxContactConstraints;
+
+		// The layer collision rules are asked once up front and kept natively, so Jolt never calls back into managed code to filter layers.
+		// Static layers get one broadphase tree and all other layers another, so the static tree is never touched by moving bodies and stays optimized.
+		JPH_ASSERT(maxNumberOfLayers <= egJoltGetMaxLayers());
+		EgJoltLayerMatrix& layerMatrix = internalInstance->layerMatrix;
+		layerMatrix.layerCount = min(maxNumberOfLayers, (unsigned char)egJoltGetMaxLayers());
+		const unsigned char cStaticBroadPhaseLayer = 0;
+		const unsigned char cMovingBroadPhaseLayer = layerMatrix.layerCount > 1 ? 1 : 0;
+		for (unsigned int i = 0; i < layerMatrix.layerCount; i++)
+		{
+			uint64 mask = 0;
+			for (unsigned int j = 0; j < layerMatrix.layerCount; j++)
+			{
+				if (!callbackShouldCollide || callbackShouldCollide(i, j))
+				{
+					mask |= uint64(1) << j;
+				}
+			}
+			layerMatrix.collisionMasks[i] = mask;
+			layerMatrix.broadPhaseLayers[i] = (instanceSettings->staticLayerMask & (uint64(1) << i)) ? cStaticBroadPhaseLayer : cMovingBroadPhaseLayer;
+		}
+		layerMatrix.UpdateBroadPhaseMasks();
 
 		// Create mapping table from object layer to broadphase layer
 		// Note: As this is an interface, PhysicsSystem will take a reference to this so this instance needs to stay alive!
 		BPLayerInterfaceImpl* broad_phase_layer_interface = new BPLayerInterfaceImpl();
-		broad_phase_layer_interface->maxNumberOfLayers = maxNumberOfLayers;
+		broad_phase_layer_interface->layerMatrix = &layerMatrix;
 
 		// Create class that filters object vs broadphase layers
 		// Note: As this is an interface, PhysicsSystem will take a reference to this so this instance needs to stay alive!
 		ObjectVsBroadPhaseLayerFilterImpl* object_vs_broadphase_layer_filter = new ObjectVsBroadPhaseLayerFilterImpl();
-		object_vs_broadphase_layer_filter->callbackShouldCollide = callbackShouldCollide;
+		object_vs_broadphase_layer_filter->layerMatrix = &layerMatrix;
 
 		// Create class that filters object vs object layers
 		// Note: As this is an interface, PhysicsSystem will take a reference to this so this instance needs to stay alive!
 		ObjectLayerPairFilterImpl* object_vs_object_layer_filter = new ObjectLayerPairFilterImpl();
-		object_vs_object_layer_filter->callbackShouldCollide = callbackShouldCollide;
+		object_vs_object_layer_filter->layerMatrix = &layerMatrix;
 
 		// Now we can create the actual physics system.
 		PhysicsSystem* physics_system = new PhysicsSystem();
 		physics_system->Init(cMaxBodies, cNumBodyMutexes, cMaxBodyPairs, cMaxContactConstraints, *broad_phase_layer_interface, *object_vs_broadphase_layer_filter, *object_vs_object_layer_filter);
 		auto settings = physics_system->GetPhysicsSettings();
-		settings.mDeterministicSimulation = true;
+		settings.mNumVelocitySteps = instanceSettings->numVelocitySteps;
+		settings.mNumPositionSteps = instanceSettings->numPositionSteps;
+		settings.mBaumgarte = instanceSettings->baumgarte;
+		settings.mSpeculativeContactDistance = instanceSettings->speculativeContactDistance;
+		settings.mPenetrationSlop = instanceSettings->penetrationSlop;
+		settings.mTimeBeforeSleep = instanceSettings->timeBeforeSleep;
+		settings.mPointVelocitySleepThreshold = instanceSettings->pointVelocitySleepThreshold;
+		settings.mAllowSleeping = instanceSettings->allowSleeping;
+		settings.mDeterministicSimulation = instanceSettings->deterministicSimulation;
 		physics_system->SetPhysicsSettings(settings);
 
 		// A body activation listener gets notified when bodies activate and go to sleep
@@ -687,33 +3929,28 @@ extern "C" {
 		// Registering one is entirely optional.
 		MyContactListener* contact_listener = new MyContactListener();
 
-		// REVIEW: This is odd isn't it? Why are we calling these here?
-		//         Well let me tell you a story.
-		//         Since these callbacks can be called into managed code,
-		//         there is a bug in NET9 where competing threads trying to
-		//         JIT one of these callbacks from multiple threads spawned by C++
-		//         incorrectly handles exceptions from C++ and the process immediately dies.
-		//for (int i = 0; i < 100; i++)
-		//{
-		//	callbackContactAdded(EgJoltContactArgs());
-		//	callbackContactPersisted(EgJoltContactArgs());
-		//}
-		contact_listener->callbackContactAdded = callbackContactAdded;
-		contact_listener->callbackContactPersisted = callbackContactPersisted;
+		// Contacts are queued from the job threads and only handed to managed code after the step, on the calling thread.
+		// Calling into managed code straight from the job threads made .NET JIT the callbacks on several native threads at once,
+		// which mishandles exceptions coming from C++ and kills the process.
+		// Every contact constraint reports an added or persisted event per step and removed contacts come on top of that.
+		contact_listener->contactQueue.SetCapacity(2 * cMaxContactConstraints);
+		contact_listener->sensorContactLog.SetCapacity(cMaxContactConstraints);
 		contact_listener->physics = physics_system;
 		physics_system->SetContactListener(contact_listener);
 
 		auto characterContactListener = new MyCharacterVirtualContactListener();
 
-		auto internalInstance = new EgJoltInstanceInternal();
 		internalInstance->temp_allocator = temp_allocator;
 		internalInstance->job_system = job_system;
+		internalInstance->collisionSteps = max(instanceSettings->collisionSteps, 1);
 		internalInstance->broad_phase_layer_interface = broad_phase_layer_interface;
 		internalInstance->object_vs_broadphase_layer_filter = object_vs_broadphase_layer_filter;
 		internalInstance->object_vs_object_layer_filter = object_vs_object_layer_filter;
 		internalInstance->physics_system = physics_system;
 		internalInstance->body_activation_listener = body_activation_listener;
 		internalInstance->contact_listener = contact_listener;
+		internalInstance->callbackContactAdded = callbackContactAdded;
+		internalInstance->callbackContactPersisted = callbackContactPersisted;
 		internalInstance->characterContactListener = characterContactListener;
 		internalInstance->bodyFilter = new MyBodyFilter();
 
@@ -729,8 +3966,18 @@ extern "C" {
 	{
 		auto internalInstance = GetInternalInstance(instance);
 
+		_egJoltWaitUpdate(internalInstance);
+
+		for (EgJoltBodyPoolInternal* pool : internalInstance->bodyPools)
+		{
+			delete pool;
+		}
 		delete internalInstance->temp_allocator;
-		delete internalInstance->job_system;
+		for (TempAllocator* tempAllocator : internalInstance->characterTempAllocators)
+		{
+			delete tempAllocator;
+		}
+		delete internalInstance->ownedJobSystem;
 		delete internalInstance->broad_phase_layer_interface;
 		delete internalInstance->object_vs_broadphase_layer_filter;
 		delete internalInstance->object_vs_object_layer_filter;
@@ -743,12 +3990,238 @@ extern "C" {
 	}
 
 	// If you take larger steps than 1 / 60th of a second you need to do multiple collision steps in order to keep the simulation stable. Do 1 collision step per 1 / 60th of a second (round up).
-	EG_EXPORT void egJoltUpdate(EgJoltInstance instance, float deltaTime, int collisionSteps)
+	EG_EXPORT EgJoltUpdateStats egJoltUpdate(EgJoltInstance instance, float deltaTime, int collisionSteps)
+	{
+		auto internalInstance = GetInternalInstance(instance);
+
+		EgJoltUpdateStats stats = _egJoltStep(internalInstance, deltaTime, collisionSteps);
+		_egJoltRunContactCallbacks(internalInstance, stats);
+		return stats;
+	}
+
+	EG_EXPORT EgJoltUpdateHandle egJoltUpdateAsync(EgJoltInstance instance, float deltaTime, int collisionSteps)
+	{
+		auto internalInstance = GetInternalInstance(instance);
+
+		EgJoltUpdateHandle handle = {};
+		if (internalInstance->updateBarrier)
+			return handle;
+
+		JobSystem* jobSystem = internalInstance->job_system;
+		internalInstance->updateJob = jobSystem->CreateJob("egJoltUpdate", Color::sOrange, [internalInstance, deltaTime, collisionSteps]()
+		{
+			internalInstance->updateStats = _egJoltStep(internalInstance, deltaTime, collisionSteps);
+			_egJoltWriteTransformSnapshot(internalInstance);
+		});
+		internalInstance->updateBarrier = jobSystem->CreateBarrier();
+		internalInstance->updateBarrier->AddJob(internalInstance->updateJob);
+
+		// Without worker threads nobody would pick the job up, so the step runs right here
+		if (jobSystem->GetMaxConcurrency() <= 1)
+		{
+			jobSystem->WaitForJobs(internalInstance->updateBarrier);
+		}
+
+		handle.internal = internalInstance;
+		return handle;
+	}
+
+	EG_EXPORT bool egJoltIsUpdateComplete(EgJoltUpdateHandle handle)
+	{
+		auto internalInstance = (EgJoltInstanceInternal*)handle.internal;
+		return !internalInstance || !internalInstance->updateBarrier || internalInstance->updateJob.IsDone();
+	}
+
+	EG_EXPORT EgJoltUpdateStats egJoltWaitUpdate(EgJoltUpdateHandle handle)
+	{
+		auto internalInstance = (EgJoltInstanceInternal*)handle.internal;
+		if (!internalInstance || !_egJoltWaitUpdate(internalInstance))
+			return {};
+
+		EgJoltUpdateStats stats = internalInstance->updateStats;
+		_egJoltRunContactCallbacks(internalInstance, stats);
+		return stats;
+	}
+
+	EG_EXPORT EgJoltMemoryStats egJoltGetMemoryStats(EgJoltInstance instance)
+	{
+		auto internalInstance = GetInternalInstance(instance);
+		const EgJoltTempAllocator* tempAllocator = internalInstance->temp_allocator;
+
+		EgJoltMemoryStats stats = {};
+		stats.heapBytes = s_heapBytes.load(memory_order_relaxed);
+		stats.heapPeakBytes = s_heapPeakBytes.load(memory_order_relaxed);
+		stats.heapAllocationCount = s_heapAllocationCount.load(memory_order_relaxed);
+		stats.allHeapAllocationsDuringStep = (unsigned int)internalInstance->allHeapAllocationsDuringStep;
+		stats.tempAllocatorSize = (unsigned int)tempAllocator->GetSize();
+		stats.tempAllocatorPeakBytes = (unsigned int)tempAllocator->GetPeakUsage();
+		stats.tempAllocatorOverflowCount = (unsigned int)tempAllocator->GetOverflowCount();
+		return stats;
+	}
+
+	EG_EXPORT EgJoltTransformSnapshot egJoltGetTransformSnapshot(EgJoltInstance instance)
+	{
+		auto internalInstance = GetInternalInstance(instance);
+		const EgJoltSnapshotBuffer& buffer = internalInstance->snapshots[internalInstance->snapshotIndex.load(memory_order_acquire)];
+
+		EgJoltTransformSnapshot snapshot = {};
+		snapshot.frame = buffer.frame;
+		snapshot.bodyCount = (unsigned int)buffer.bodyIds.size();
+		snapshot.bodyIds = buffer.bodyIds.data();
+		snapshot.positions = buffer.positions.data();
+		snapshot.rotations = buffer.rotations.data();
+		return snapshot;
+	}
+
+	EG_EXPORT void egJoltSetLayerCollisionMatrix(EgJoltInstance instance, const unsigned long long* masks, unsigned int count)
+	{
+		EgJoltLayerMatrix& layerMatrix = GetInternalInstance(instance)->layerMatrix;
+
+		count = min(count, (unsigned int)layerMatrix.layerCount);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			layerMatrix.collisionMasks[i] = masks[i];
+		}
+		layerMatrix.UpdateBroadPhaseMasks();
+	}
+
+	EG_EXPORT bool egJoltSetBroadPhaseLayers(EgJoltInstance instance, const unsigned char* broadPhaseLayers, unsigned int count)
 	{
 		auto internalInstance = GetInternalInstance(instance);
+		EgJoltLayerMatrix& layerMatrix = internalInstance->layerMatrix;
+
+		// Bodies already in the broadphase would end up in the wrong tree.
+		if (internalInstance->physics_system->GetNumBodies() > 0)
+			return false;
+
+		count = min(count, (unsigned int)layerMatrix.layerCount);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			if (broadPhaseLayers[i] >= layerMatrix.layerCount)
+				return false;
+		}
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			layerMatrix.broadPhaseLayers[i] = broadPhaseLayers[i];
+		}
+		layerMatrix.UpdateBroadPhaseMasks();
+		return true;
+	}
+
+	EG_EXPORT unsigned int egJoltDrainContacts(EgJoltInstance instance, EgJoltContactArgs* buffer, unsigned int capacity)
+	{
+		auto& contactQueue = GetInternalInstance(instance)->contact_listener->contactQueue;
+
+		unsigned int count = min(contactQueue.GetCount() - contactQueue.readIndex, capacity);
+		memcpy(buffer, contactQueue.events.data() + contactQueue.readIndex, count * sizeof(EgJoltContactArgs));
+		contactQueue.readIndex += count;
+		return count;
+	}
+
+	EG_EXPORT void egJoltSetContactQueueCapacity(EgJoltInstance instance, unsigned int capacity)
+	{
+		GetInternalInstance(instance)->contact_listener->contactQueue.SetCapacity(capacity);
+	}
+
+	EG_EXPORT unsigned int egJoltGetTriggerEvents(EgJoltInstance instance, unsigned long long layerMask, EgJoltTriggerArgs* events, unsigned int capacity)
+	{
+		auto& triggerEvents = GetInternalInstance(instance)->triggerEvents;
+
+		unsigned int count = 0;
+		for (const EgJoltTriggerArgs& args : triggerEvents)
+		{
+			if ((layerMask & (uint64(1) << args.otherLayer)) == 0)
+				continue;
+
+			if (count < capacity)
+			{
+				events[count] = args;
+			}
+			count++;
+		}
+		return count;
+	}
+
+	EG_EXPORT unsigned int egJoltGetActiveBodies(EgJoltInstance instance, unsigned int* bodyIds, unsigned int capacity)
+	{
+		auto& changedBodies = GetInternalInstance(instance)->changedBodies;
+
+		unsigned int count = (unsigned int)changedBodies.size();
+		memcpy(bodyIds, changedBodies.data(), min(count, capacity) * sizeof(unsigned int));
+		return count;
+	}
+
+	EG_EXPORT unsigned int egJoltGetActivationChanges(EgJoltInstance instance, EgJoltActivationChange* changes, unsigned int capacity)
+	{
+		auto& activationChanges = GetInternalInstance(instance)->activationChanges;
+
+		unsigned int count = (unsigned int)activationChanges.size();
+		memcpy(changes, activationChanges.data(), min(count, capacity) * sizeof(EgJoltActivationChange));
+		return count;
+	}
+
+	EG_EXPORT unsigned int egJoltSaveState(EgJoltInstance instance, EgJolt_StateFlags flags, void* buffer, unsigned int bufferSize)
+	{
+		EgJoltMemoryStateRecorder recorder(buffer, buffer ? bufferSize : 0);
+		_egJoltSaveState(instance, flags, recorder);
+		return (unsigned int)recorder.GetSize();
+	}
+
+	EG_EXPORT bool egJoltRestoreState(EgJoltInstance instance, const void* buffer, unsigned int bufferSize)
+	{
+		if (!buffer || bufferSize == 0)
+			return false;
+
+		EgJoltMemoryStateRecorder recorder(const_cast<void*>(buffer), bufferSize);
+		return _egJoltRestoreState(instance, recorder);
+	}
+
+	EG_EXPORT void egJoltSetStateHistoryCapacity(EgJoltInstance instance, unsigned int frameCount)
+	{
+		auto& stateHistory = GetInternalInstance(instance)->stateHistory;
+		stateHistory.resize(frameCount);
+		for (auto& stateFrame : stateHistory)
+		{
+			stateFrame.isValid = false;
+		}
+	}
+
+	EG_EXPORT unsigned int egJoltSaveStateToHistory(EgJoltInstance instance, unsigned int frame, EgJolt_StateFlags flags)
+	{
+		auto& stateHistory = GetInternalInstance(instance)->stateHistory;
+		if (stateHistory.empty())
+			return 0;
+
+		// The frame's storage is kept between saves, so once the ring is warm this does not allocate.
+		auto& stateFrame = stateHistory[frame % stateHistory.size()];
+		stateFrame.data.clear();
+
+		EgJoltMemoryStateRecorder recorder(&stateFrame.data);
+		_egJoltSaveState(instance, flags, recorder);
+
+		stateFrame.frame = frame;
+		stateFrame.isValid = true;
+		return (unsigned int)recorder.GetSize();
+	}
+
+	EG_EXPORT bool egJoltRestoreStateFromHistory(EgJoltInstance instance, unsigned int frame)
+	{
+		auto& stateHistory = GetInternalInstance(instance)->stateHistory;
+		if (stateHistory.empty())
+			return false;
+
+		auto& stateFrame = stateHistory[frame % stateHistory.size()];
+		if (!stateFrame.isValid || stateFrame.frame != frame)
+			return false;
+
+		EgJoltMemoryStateRecorder recorder(&stateFrame.data);
+		return _egJoltRestoreState(instance, recorder);
+	}
 
-		// Step the world
-		internalInstance->physics_system->Update(deltaTime, collisionSteps, internalInstance->temp_allocator, internalInstance->job_system);
+	EG_EXPORT unsigned long long egJoltComputeStateHash(EgJoltInstance instance, unsigned long long layerMask, EgJoltIslandHash* islandHashes, unsigned int islandCapacity, unsigned int* islandCount)
+	{
+		return _egJoltComputeStateHash(GetInternalInstance(instance), layerMask, islandHashes, islandCapacity, islandCount);
 	}
 
 	EG_EXPORT void egJoltSetGravity(EgJoltInstance instance, EgJoltVector3 gravity)
@@ -823,7 +4296,145 @@ extern "C" {
 
 		MeshShapeSettings jSettings(std::move(vertexList), std::move(indexList));
 
-		auto jResult = jSettings.Create();
+		auto jResult = jSettings.Create();
+		if (!jResult.IsValid())
+		{
+			return false;
+		}
+
+		JPH::Ref<JPH::Shape> jShapeRef = jResult.Get();
+		auto jShape = jShapeRef.GetPtr();
+		jShape->AddRef();
+
+		EgJoltShape shape;
+		shape.internal = jShape;
+		*outShape = shape;
+		return true;
+	}
+
+	EG_EXPORT bool egJoltCreateCompoundShape(EgJoltShape* shapes, int shapeCount, EgJoltShape* outShape)
+	{
+		if (!shapes)
+			return false;
+
+		if (shapeCount <= 0)
+			return false;
+
+		Ref<StaticCompoundShapeSettings> jSettings = new StaticCompoundShapeSettings;
+
+		for (unsigned int k = 0; k < shapeCount; k++)
+		{
+			auto shape = shapes[k];
+			jSettings->AddShape(Vec3Arg::sZero(), QuatArg::sIdentity(), (JPH::Shape*)shape.internal);
+		}
+
+		auto jResult = jSettings->Create();
+		if (!jResult.IsValid())
+		{
+			return false;
+		}
+
+		JPH::Ref<JPH::Shape> jShapeRef = jResult.Get();
+		auto jShape = jShapeRef.GetPtr();
+		jShape->AddRef();
+
+		EgJoltShape shape;
+		shape.internal = jShape;
+		*outShape = shape;
+		return true;
+	}
+
+	EG_EXPORT bool egJoltDestroyShape(EgJoltShape shape)
+	{
+		if (!shape.internal)
+		{
+			return false;
+		}
+
+		auto jShape = (JPH::Shape*)shape.internal;
+		auto success = jShape->GetRefCount() == 1;
+		jShape->Release();
+		return success;
+	}
+
+	EG_EXPORT bool egJoltCreateCompoundMeshShape(EgJoltCompoundMesh compoundMesh, EgJoltShape* outShape)
+	{
+		auto jResult = _egJoltCreateCompoundMeshShape(compoundMesh);
+		if (!jResult.IsValid())
+		{
+			return false;
+		}
+
+		JPH::Ref<JPH::Shape> jShapeRef = jResult.Get();
+		auto jShape = jShapeRef.GetPtr();
+		jShape->AddRef();
+
+		EgJoltShape shape;
+		shape.internal = jShape;
+		*outShape = shape;
+		return true;
+	}
+
+	EG_EXPORT bool egJoltCreateConvexHullShape(EgJoltConvexHullShapeSettings settings, EgJoltShape* outShape)
+	{
+		if (!settings.points || settings.pointCount < 4)
+			return false;
+
+		Array<Vec3> points(settings.pointCount);
+		for (unsigned int i = 0; i < settings.pointCount; i++)
+		{
+			points[i] = ConvertVector3(settings.points[i]);
+		}
+
+		auto jResult = _egJoltCreateConvexHullShape(points, settings.maxVertexCount, settings.density);
+		if (!jResult.IsValid())
+		{
+			return false;
+		}
+
+		JPH::Ref<JPH::Shape> jShapeRef = jResult.Get();
+		auto jShape = jShapeRef.GetPtr();
+		jShape->AddRef();
+
+		EgJoltShape shape;
+		shape.internal = jShape;
+		*outShape = shape;
+		return true;
+	}
+
+	EG_EXPORT bool egJoltCreateConvexDecompositionShape(EgJoltMesh mesh, EgJoltConvexDecompositionSettings settings, EgJoltShape* outShape)
+	{
+		if (!mesh.vertices || !mesh.indices || mesh.indexCount < 3)
+			return false;
+
+		for (unsigned int i = 0; i < mesh.indexCount; i++)
+		{
+			if (mesh.indices[i] >= mesh.vertexCount)
+				return false;
+		}
+
+		auto jResult = _egJoltCreateConvexDecompositionShape(mesh, settings);
+		if (!jResult.IsValid())
+		{
+			return false;
+		}
+
+		JPH::Ref<JPH::Shape> jShapeRef = jResult.Get();
+		auto jShape = jShapeRef.GetPtr();
+		jShape->AddRef();
+
+		EgJoltShape shape;
+		shape.internal = jShape;
+		*outShape = shape;
+		return true;
+	}
+
+	EG_EXPORT bool egJoltCreateHeightFieldShape(EgJoltHeightFieldShapeSettings settings, EgJoltShape* outShape)
+	{
+		if (!settings.samples || settings.sampleCount < 2)
+			return false;
+
+		auto jResult = _egJoltCreateHeightFieldShape(settings);
 		if (!jResult.IsValid())
 		{
 			return false;
@@ -839,24 +4450,56 @@ extern "C" {
 		return true;
 	}
 
-	EG_EXPORT bool egJoltCreateCompoundShape(EgJoltShape* shapes, int shapeCount, EgJoltShape* outShape)
+	EG_EXPORT bool egJoltSetHeightFieldHeights(EgJoltInstance instance, unsigned int bodyId, unsigned int x, unsigned int y, unsigned int sizeX, unsigned int sizeY, const float* heights)
 	{
-		if (!shapes)
-			return false;
+		return _egJoltSetHeightFieldHeights(GetInternalInstance(instance), ConvertBodyId(bodyId), x, y, sizeX, sizeY, heights);
+	}
 
-		if (shapeCount <= 0)
-			return false;
+	EG_EXPORT EgJoltShapeRegistryStats egJoltGetShapeRegistryStats()
+	{
+		return s_shapeRegistry->GetStats();
+	}
 
-		Ref<StaticCompoundShapeSettings> jSettings = new StaticCompoundShapeSettings;
+	EG_EXPORT unsigned int egJoltPruneShapeRegistry()
+	{
+		return s_shapeRegistry->Prune();
+	}
 
-		for (unsigned int k = 0; k < shapeCount; k++)
+	EG_EXPORT unsigned long long egJoltHashMesh(const EgJoltVector3* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+	{
+		return _egJoltHashMesh(vertices, vertexCount, indices, indexCount, 0xcbf29ce484222325UL);
+	}
+
+	EG_EXPORT unsigned long long egJoltHashCompoundMesh(EgJoltCompoundMesh compoundMesh)
+	{
+		return _egJoltHashCompoundMesh(compoundMesh);
+	}
+
+	EG_EXPORT unsigned int egJoltSaveShape(EgJoltShape shape, unsigned long long contentHash, void* buffer, unsigned int bufferSize)
+	{
+		if (!shape.internal)
+			return 0;
+
+		// Shapes stop writing their children once the stream has failed, so the size can only be known from a complete write.
+		Array<uint8> blob;
+		EgJoltMemoryStateRecorder recorder(&blob);
+		_egJoltSaveShape((const Shape*)shape.internal, contentHash, recorder);
+
+		if (buffer && blob.size() <= bufferSize)
 		{
-			auto shape = shapes[k];
-			jSettings->AddShape(Vec3Arg::sZero(), QuatArg::sIdentity(), (JPH::Shape*)shape.internal);
+			memcpy(buffer, blob.data(), blob.size());
 		}
+		return (unsigned int)blob.size();
+	}
 
-		auto jResult = jSettings->Create();
-		if (!jResult.IsValid())
+	EG_EXPORT bool egJoltLoadShapeFromMemory(const void* buffer, unsigned int bufferSize, unsigned long long contentHash, EgJoltShape* outShape)
+	{
+		if (!buffer || bufferSize < sizeof(EgJoltShapeBlobHeader))
+			return false;
+
+		EgJoltMemoryStateRecorder recorder(const_cast<void*>(buffer), bufferSize);
+		auto jResult = _egJoltLoadShape(recorder, contentHash);
+		if (!jResult.IsValid() || recorder.IsFailed())
 		{
 			return false;
 		}
@@ -871,27 +4514,101 @@ extern "C" {
 		return true;
 	}
 
-	EG_EXPORT bool egJoltDestroyShape(EgJoltShape shape)
+	EG_EXPORT EgJoltBodyCreationOptions egJoltGetDefaultBodyCreationOptions()
 	{
-		if (!shape.internal)
+		return _egJoltGetDefaultBodyCreationOptions();
+	}
+
+	EG_EXPORT bool egJoltCreateStaticBody(EgJoltInstance instance, EgJoltShape shape, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
+	{
+		return _egJoltAddBody2(instance, JPH::EMotionType::Static, state->layer, 0, (Shape*)shape.internal, userData, (BodyID*)bodyId, state, options);
+	}
+
+	EG_EXPORT unsigned int egJoltCreateStaticBodies(EgJoltInstance instance, const EgJoltShape* shapes, const unsigned long long* userData, const EgJoltBodyState* states, const EgJoltBodyCreationOptions* options, unsigned int count, unsigned int* bodyIds)
+	{
+		return _egJoltAddBodies(instance, EMotionType::Static, shapes, nullptr, userData, states, options, count, bodyIds);
+	}
+
+	EG_EXPORT unsigned int egJoltCreateDynamicBodies(EgJoltInstance instance, const EgJoltShape* shapes, const float* masses, const unsigned long long* userData, const EgJoltBodyState* states, const EgJoltBodyCreationOptions* options, unsigned int count, unsigned int* bodyIds)
+	{
+		if (!masses)
+			return 0;
+
+		return _egJoltAddBodies(instance, EMotionType::Dynamic, shapes, masses, userData, states, options, count, bodyIds);
+	}
+
+	EG_EXPORT unsigned int egJoltExportScene(EgJoltInstance instance, unsigned long long layerMask, void* buffer, unsigned int bufferSize)
+	{
+		// Bodies stop writing their shapes once the stream has failed, so the size can only be known from a complete write.
+		Array<uint8> blob;
+		EgJoltMemoryStateRecorder recorder(&blob);
+		_egJoltExportScene(GetInternalInstance(instance), layerMask, recorder);
+
+		if (buffer && blob.size() <= bufferSize)
 		{
-			return false;
+			memcpy(buffer, blob.data(), blob.size());
 		}
+		return (unsigned int)blob.size();
+	}
 
-		auto jShape = (JPH::Shape*)shape.internal;
-		auto success = jShape->GetRefCount() == 1;
-		jShape->Release();
-		return success;
+	EG_EXPORT unsigned int egJoltGetSceneBodyCount(const void* buffer, unsigned int bufferSize)
+	{
+		if (!buffer || bufferSize < sizeof(EgJoltSceneBlobHeader))
+			return 0;
+
+		EgJoltSceneBlobHeader header;
+		memcpy(&header, buffer, sizeof(header));
+		if (!_egJoltIsValidSceneBlobHeader(header))
+			return 0;
+		return header.bodyCount;
+	}
+
+	EG_EXPORT bool egJoltImportScene(EgJoltInstance instance, const void* buffer, unsigned int bufferSize, unsigned int* bodyIds, unsigned int bodyIdCapacity, unsigned int* bodyCount)
+	{
+		if (bodyCount)
+		{
+			*bodyCount = 0;
+		}
+		if (!buffer || bufferSize < sizeof(EgJoltSceneBlobHeader))
+			return false;
+
+		EgJoltMemoryStateRecorder recorder(const_cast<void*>(buffer), bufferSize);
+		return _egJoltImportScene(GetInternalInstance(instance), recorder, bodyIds, bodyIds ? bodyIdCapacity : 0, bodyCount);
+	}
+
+	EG_EXPORT bool egJoltCreateDynamicBody(EgJoltInstance instance, EgJoltShape shape, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
+	{
+		return _egJoltAddBody2(instance, JPH::EMotionType::Dynamic, state->layer, mass, (Shape*)shape.internal, userData, (BodyID*)bodyId, state, options);
 	}
 
-	EG_EXPORT bool egJoltCreateStaticBody(EgJoltInstance instance, EgJoltShape shape, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state)
+	EG_EXPORT EgJoltBodyPool egJoltCreateBodyPool(EgJoltInstance instance, EgJoltShape shape, float mass, const EgJoltBodyCreationOptions* options, unsigned int count)
 	{
-		return _egJoltAddBody2(instance, JPH::EMotionType::Static, state->layer, 0, (Shape*)shape.internal, userData, (BodyID*)bodyId, state);
+		return _egJoltCreateBodyPool(GetInternalInstance(instance), (const Shape*)shape.internal, mass, options, count);
 	}
 
-	EG_EXPORT bool egJoltCreateDynamicBody(EgJoltInstance instance, EgJoltShape shape, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state)
+	EG_EXPORT void egJoltDestroyBodyPool(EgJoltInstance instance, EgJoltBodyPool pool)
 	{
-		return _egJoltAddBody2(instance, JPH::EMotionType::Dynamic, state->layer, mass, (Shape*)shape.internal, userData, (BodyID*)bodyId, state);
+		_egJoltDestroyBodyPool(GetInternalInstance(instance), GetInternalBodyPool(pool));
+	}
+
+	EG_EXPORT unsigned int egJoltGetBodyPoolFreeCount(EgJoltBodyPool pool)
+	{
+		return (unsigned int)GetInternalBodyPool(pool)->freeSlots.size();
+	}
+
+	EG_EXPORT unsigned int egJoltAcquirePooledBody(EgJoltInstance instance, EgJoltBodyPool pool, unsigned long long userData, const EgJoltBodyState* state)
+	{
+		return _egJoltAcquirePooledBody(GetInternalInstance(instance), GetInternalBodyPool(pool), userData, state);
+	}
+
+	EG_EXPORT bool egJoltReleasePooledBody(EgJoltInstance instance, EgJoltBodyPool pool, unsigned int bodyId)
+	{
+		return _egJoltReleasePooledBody(GetInternalBodyPool(pool), bodyId);
+	}
+
+	EG_EXPORT void egJoltFlushBodyPools(EgJoltInstance instance)
+	{
+		_egJoltFlushBodyPools(GetInternalInstance(instance));
 	}
 
 	EG_EXPORT unsigned int egJoltGetCharacterBodyId(EgJoltInstance instance, EgJoltCharacter character)
@@ -903,37 +4620,22 @@ extern "C" {
 
 	EG_EXPORT bool egJoltAreBodiesColliding(EgJoltInstance instance, unsigned int bodyId1, unsigned int bodyId2)
 	{
-		auto physicsSystem = GetInternalInstance(instance)->physics_system;
-		auto& bodyInterface = physicsSystem->GetBodyInterfaceNoLock();
-
-		auto shape = bodyInterface.GetShape(ConvertBodyId(bodyId1));
-		auto bodyID1 = ConvertBodyId(bodyId1);
-		auto bodyID2 = ConvertBodyId(bodyId2);
-
-		// Settings
-		CollideShapeSettings settings;
-		settings.mActiveEdgeMode = EActiveEdgeMode::CollideWithAll;
-		settings.mBackFaceMode = EBackFaceMode::IgnoreBackFaces;
+		auto& contactPairs = GetInternalInstance(instance)->contactPairs;
+		return contactPairs.find(_egJoltGetContactPairKey(bodyId1, bodyId2)) != contactPairs.end();
+	}
 
-		AllHitCollisionCollector<CollideShapeCollector> collector;
-		physicsSystem->GetNarrowPhaseQuery().CollideShape(shape, Vec3::sReplicate(1.0f), bodyInterface.GetCenterOfMassTransform(bodyID1), settings, RVec3::sZero(), collector);
-		if (collector.HadHit())
-		{
-			auto count = collector.mHits.size();
-			for (int i = 0; i < count; i++)
-			{
-				if (collector.mHits[i].mBodyID2 == bodyID2)
-				{
-					return true;
-				}
-			}
+	EG_EXPORT unsigned int egJoltAreBodiesCollidingMany(EgJoltInstance instance, const unsigned int* bodyIds1, const unsigned int* bodyIds2, unsigned int count, bool* results)
+	{
+		auto& contactPairs = GetInternalInstance(instance)->contactPairs;
 
-			return false;
-		}
-		else
+		unsigned int collidingCount = 0;
+		for (unsigned int i = 0; i < count; i++)
 		{
-			return false;
+			bool isColliding = contactPairs.find(_egJoltGetContactPairKey(bodyIds1[i], bodyIds2[i])) != contactPairs.end();
+			results[i] = isColliding;
+			collidingCount += isColliding;
 		}
+		return collidingCount;
 	}
 
 	EG_EXPORT void egJolt_Body_InvalidateContactCache(EgJoltInstance instance, unsigned int bodyId)
@@ -946,29 +4648,29 @@ extern "C" {
 		GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock().SetGravityFactor(ConvertBodyId(bodyId), gravityFactor);
 	}
 
-	EG_EXPORT unsigned int egJoltAddBodyDynamicBox(EgJoltInstance instance, EgJoltVector3 scale, float density, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state)
+	EG_EXPORT unsigned int egJoltAddBodyDynamicBox(EgJoltInstance instance, EgJoltVector3 scale, float density, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
 	{
-		return _egJoltAddBodyBox(instance, scale, EMotionType::Dynamic, state->layer, density, mass, userData, (BodyID*)bodyId, state);
+		return _egJoltAddBodyBox(instance, scale, EMotionType::Dynamic, state->layer, density, mass, userData, (BodyID*)bodyId, state, options);
 	}
 
-	EG_EXPORT unsigned int egJoltAddBodyDynamicSphere(EgJoltInstance instance, float radius, float density, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state)
+	EG_EXPORT unsigned int egJoltAddBodyDynamicSphere(EgJoltInstance instance, float radius, float density, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
 	{
-		return _egJoltAddBodySphere(instance, radius, EMotionType::Dynamic, state->layer, density, mass, userData, (BodyID*)bodyId, state);
+		return _egJoltAddBodySphere(instance, radius, EMotionType::Dynamic, state->layer, density, mass, userData, (BodyID*)bodyId, state, options);
 	}
 
-	EG_EXPORT unsigned int egJoltAddBodyStaticBox(EgJoltInstance instance, EgJoltVector3 scale, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state)
+	EG_EXPORT unsigned int egJoltAddBodyStaticBox(EgJoltInstance instance, EgJoltVector3 scale, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
 	{
-		return _egJoltAddBodyBox(instance,  scale, EMotionType::Static, state->layer, 0, 0, userData, (BodyID*)bodyId, state);
+		return _egJoltAddBodyBox(instance,  scale, EMotionType::Static, state->layer, 0, 0, userData, (BodyID*)bodyId, state, options);
 	}
 
-	EG_EXPORT unsigned int egJoltAddBodyStaticMesh(EgJoltInstance instance, EgJoltVector3* vertices, int vertexCount, unsigned int* indices, int indexCount, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state)
+	EG_EXPORT unsigned int egJoltAddBodyStaticMesh(EgJoltInstance instance, EgJoltVector3* vertices, int vertexCount, unsigned int* indices, int indexCount, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
 	{
-		return _egJoltAddBodyMesh(instance, vertices, vertexCount, indices, indexCount, EMotionType::Static, state->layer, 0, userData, (BodyID*)bodyId, state);
+		return _egJoltAddBodyMesh(instance, vertices, vertexCount, indices, indexCount, EMotionType::Static, state->layer, 0, userData, (BodyID*)bodyId, state, options);
 	}
 
-	EG_EXPORT unsigned int egJoltAddBodyStaticCompoundMesh(EgJoltInstance instance, EgJoltCompoundMesh compoundMesh, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state)
+	EG_EXPORT unsigned int egJoltAddBodyStaticCompoundMesh(EgJoltInstance instance, EgJoltCompoundMesh compoundMesh, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options)
 	{
-		return _egJoltAddStaticBodyCompoundMesh(instance, compoundMesh, EMotionType::Static, state->layer, 0, userData, (BodyID*)bodyId, state);
+		return _egJoltAddStaticBodyCompoundMesh(instance, compoundMesh, EMotionType::Static, state->layer, 0, userData, (BodyID*)bodyId, state, options);
 	}
 
 	EG_EXPORT unsigned long long egJoltGetBodyUserData(EgJoltInstance instance, unsigned int bodyId)
@@ -1003,6 +4705,19 @@ extern "C" {
 		body_interface.DestroyBody(*(BodyID*)&bodyId);
 	}
 
+	EG_EXPORT void egJoltRemoveBodies(EgJoltInstance instance, const unsigned int* bodyIds, unsigned int bodyCount)
+	{
+		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
+
+		if (bodyCount == 0)
+			return;
+
+		// RemoveBodies reorders the ids it is given
+		Array<BodyID> ids((const BodyID*)bodyIds, (const BodyID*)bodyIds + bodyCount);
+		body_interface.RemoveBodies(ids.data(), (int)ids.size());
+		body_interface.DestroyBodies(ids.data(), (int)ids.size());
+	}
+
 	EG_EXPORT bool egJoltIsBodyActive(EgJoltInstance instance, unsigned int bodyId)
 	{
 		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
@@ -1014,21 +4729,69 @@ extern "C" {
 	{
 		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
 
-		body_interface.AddImpulse(ConvertBodyId(bodyId), RVec3Arg(impulse.x, impulse.y, impulse.z));
+		body_interface.AddImpulse(ConvertBodyId(bodyId), Vec3(impulse.x, impulse.y, impulse.z));
 	}
 
 	EG_EXPORT void egJoltAddBodyAngularImpulse(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 angularImpulse)
 	{
 		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
 
-		body_interface.AddAngularImpulse(ConvertBodyId(bodyId), RVec3Arg(angularImpulse.x, angularImpulse.y, angularImpulse.z));
+		body_interface.AddAngularImpulse(ConvertBodyId(bodyId), Vec3(angularImpulse.x, angularImpulse.y, angularImpulse.z));
 	}
 
 	EG_EXPORT void egJoltSetBodyPosition(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 position)
 	{
 		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
 
-		body_interface.SetPosition(ConvertBodyId(bodyId), RVec3Arg(position.x, position.y, position.z), GetActivation(body_interface, ConvertBodyId(bodyId)));
+		body_interface.SetPosition(ConvertBodyId(bodyId), ConvertRVec3(position), GetActivation(body_interface, ConvertBodyId(bodyId)));
+	}
+
+	EG_EXPORT bool egJoltIsDoublePrecision()
+	{
+#ifdef JPH_DOUBLE_PRECISION
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	EG_EXPORT void egJoltShiftOrigin(EgJoltInstance instance, EgJoltDVector3 offset)
+	{
+		_egJoltShiftOrigin(GetInternalInstance(instance), ConvertRVec3(offset));
+	}
+
+	EG_EXPORT void egJoltSetBodyPositionD(EgJoltInstance instance, unsigned int bodyId, EgJoltDVector3 position)
+	{
+		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
+
+		body_interface.SetPosition(ConvertBodyId(bodyId), ConvertRVec3(position), GetActivation(body_interface, ConvertBodyId(bodyId)));
+	}
+
+	EG_EXPORT EgJoltDVector3 egJoltGetBodyPositionD(EgJoltInstance instance, unsigned int bodyId)
+	{
+		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
+
+		return ConvertDVector3(body_interface.GetPosition(ConvertBodyId(bodyId)));
+	}
+
+	EG_EXPORT void egJoltSetBodyPositionAndRotationD(EgJoltInstance instance, unsigned int bodyId, EgJoltDVector3 position, EgJoltQuaternion rotation)
+	{
+		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
+
+		body_interface.SetPositionAndRotation(ConvertBodyId(bodyId), ConvertRVec3(position), QuatArg(rotation.x, rotation.y, rotation.z, rotation.w), GetActivation(body_interface, ConvertBodyId(bodyId)));
+	}
+
+	EG_EXPORT void egJoltGetBodyPositionAndRotationD(EgJoltInstance instance, unsigned int bodyId, EgJoltDVector3& position, EgJoltQuaternion& rotation)
+	{
+		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
+
+		RVec3 _position = {};
+		Quat _rotation = {};
+
+		body_interface.GetPositionAndRotation(ConvertBodyId(bodyId), _position, _rotation);
+
+		position = ConvertDVector3(_position);
+		rotation = ConvertQuaternion(_rotation);
 	}
 
 	EG_EXPORT void egJoltSetBodyPositionAndRotationAndVelocity(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 position, EgJoltQuaternion rotation, EgJoltVector3 linearVelocity, EgJoltVector3 angularVelocity)
@@ -1037,11 +4800,11 @@ extern "C" {
 
 		if (body_interface.IsActive(ConvertBodyId(bodyId)))
 		{
-			body_interface.SetPositionRotationAndVelocity(ConvertBodyId(bodyId), ConvertVector3(position), *(Quat*)&rotation, ConvertVector3(linearVelocity), ConvertVector3(angularVelocity));
+			body_interface.SetPositionRotationAndVelocity(ConvertBodyId(bodyId), ConvertRVec3(position), *(Quat*)&rotation, ConvertVector3(linearVelocity), ConvertVector3(angularVelocity));
 		}
 		else
 		{
-			body_interface.SetPositionAndRotation(ConvertBodyId(bodyId), ConvertVector3(position), *(Quat*)&rotation, EActivation::DontActivate);
+			body_interface.SetPositionAndRotation(ConvertBodyId(bodyId), ConvertRVec3(position), *(Quat*)&rotation, EActivation::DontActivate);
 		}
 	}
 
@@ -1049,7 +4812,7 @@ extern "C" {
 	{
 		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
 
-		body_interface.SetPosition(ConvertBodyId(bodyId), RVec3Arg(position.x, position.y, position.z), GetActivation(body_interface, ConvertBodyId(bodyId)));
+		body_interface.SetPosition(ConvertBodyId(bodyId), ConvertRVec3(position), GetActivation(body_interface, ConvertBodyId(bodyId)));
 
 		if (body_interface.IsActive(ConvertBodyId(bodyId)))
 		{
@@ -1085,7 +4848,7 @@ extern "C" {
 	{
 		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
 
-		body_interface.SetPositionAndRotation(ConvertBodyId(bodyId), RVec3Arg(position.x, position.y, position.z), QuatArg(rotation.x, rotation.y, rotation.z, rotation.w), GetActivation(body_interface, ConvertBodyId(bodyId)));
+		body_interface.SetPositionAndRotation(ConvertBodyId(bodyId), ConvertRVec3(position), QuatArg(rotation.x, rotation.y, rotation.z, rotation.w), GetActivation(body_interface, ConvertBodyId(bodyId)));
 	}
 
 	EG_EXPORT void egJoltGetBodyPositionAndRotation(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3& position, EgJoltQuaternion& rotation)
@@ -1128,8 +4891,8 @@ extern "C" {
 	{
 		BodyInterface& body_interface = GetInternalInstance(instance)->physics_system->GetBodyInterfaceNoLock();
 
-		RVec3 _linearVelocity = {};
-		RVec3 _angularVelocity = {};
+		Vec3 _linearVelocity = {};
+		Vec3 _angularVelocity = {};
 
 		body_interface.GetLinearAndAngularVelocity(*(BodyID const*)&bodyId, _linearVelocity, _angularVelocity);
 
@@ -1148,6 +4911,118 @@ extern "C" {
 		egJoltGetBodyVelocity(instance, bodyId, linearVelocity, angularVelocity);
 	}
 
+	/* QUERIES */
+
+	EG_EXPORT unsigned int egJoltCastRays(EgJoltInstance instance, const EgJoltRayCast* rayCasts, unsigned int count, EgJoltRayCastResult* results)
+	{
+		auto internalInstance = GetInternalInstance(instance);
+
+		atomic<unsigned int> hitCount = 0;
+		_egJoltParallelFor(internalInstance->job_system, count, cQueryBatchSize, [&](unsigned int start, unsigned int end)
+		{
+			unsigned int batchHitCount = 0;
+			for (unsigned int i = start; i < end; i++)
+			{
+				if (_egJoltCastRay(internalInstance, rayCasts[i], results[i]))
+				{
+					batchHitCount++;
+				}
+			}
+			hitCount.fetch_add(batchHitCount, memory_order_relaxed);
+		});
+		return hitCount;
+	}
+
+	EG_EXPORT unsigned int egJoltCastShapes(EgJoltInstance instance, const EgJoltShapeCast* shapeCasts, unsigned int count, EgJoltShapeCastResult* results)
+	{
+		auto internalInstance = GetInternalInstance(instance);
+
+		atomic<unsigned int> hitCount = 0;
+		_egJoltParallelFor(internalInstance->job_system, count, cQueryBatchSize, [&](unsigned int start, unsigned int end)
+		{
+			unsigned int batchHitCount = 0;
+			for (unsigned int i = start; i < end; i++)
+			{
+				if (_egJoltCastShape(internalInstance, shapeCasts[i], results[i]))
+				{
+					batchHitCount++;
+				}
+			}
+			hitCount.fetch_add(batchHitCount, memory_order_relaxed);
+		});
+		return hitCount;
+	}
+
+	EG_EXPORT unsigned int egJoltOverlapSpheres(EgJoltInstance instance, const EgJoltSphereOverlap* overlaps, unsigned int count, EgJoltOverlapHit* hits, unsigned int hitCapacity, unsigned int* hitOffsets)
+	{
+		auto internalInstance = GetInternalInstance(instance);
+		return _egJoltOverlap(internalInstance, count, hits, hitCapacity, hitOffsets, [&](unsigned int i, Array<EgJoltOverlapHit>& queryHits)
+		{
+			_egJoltOverlapSphere(internalInstance, overlaps[i], queryHits);
+		});
+	}
+
+	EG_EXPORT unsigned int egJoltOverlapBoxes(EgJoltInstance instance, const EgJoltBoxOverlap* overlaps, unsigned int count, EgJoltOverlapHit* hits, unsigned int hitCapacity, unsigned int* hitOffsets)
+	{
+		auto internalInstance = GetInternalInstance(instance);
+		return _egJoltOverlap(internalInstance, count, hits, hitCapacity, hitOffsets, [&](unsigned int i, Array<EgJoltOverlapHit>& queryHits)
+		{
+			_egJoltOverlapBox(internalInstance, overlaps[i], queryHits);
+		});
+	}
+
+	EG_EXPORT void egJoltSetLagCompensationCapacity(EgJoltInstance instance, unsigned int tickCount)
+	{
+		auto& history = GetInternalInstance(instance)->lagCompensationHistory;
+		history.resize(tickCount);
+		for (auto& historyTick : history)
+		{
+			historyTick.isValid = false;
+		}
+	}
+
+	EG_EXPORT void egJoltSetLagCompensatedBodies(EgJoltInstance instance, const unsigned int* bodyIds, unsigned int count)
+	{
+		auto& bodies = GetInternalInstance(instance)->lagCompensatedBodies;
+		bodies.assign((const BodyID*)bodyIds, (const BodyID*)bodyIds + count);
+	}
+
+	EG_EXPORT bool egJoltRecordLagCompensationTick(EgJoltInstance instance, unsigned int tick)
+	{
+		return _egJoltRecordHistoryTick(GetInternalInstance(instance), tick);
+	}
+
+	EG_EXPORT unsigned int egJoltCastRaysAtTick(EgJoltInstance instance, unsigned int tick, const EgJoltRayCast* rayCasts, unsigned int count, EgJoltRayCastResult* results)
+	{
+		auto internalInstance = GetInternalInstance(instance);
+
+		const EgJoltHistoryTick* historyTick = _egJoltFindHistoryTick(internalInstance, tick);
+		if (!historyTick)
+		{
+			for (unsigned int i = 0; i < count; i++)
+			{
+				results[i] = {};
+				results[i].bodyId = BodyID::cInvalidBodyID;
+			}
+			return 0;
+		}
+
+		atomic<unsigned int> hitCount = 0;
+		_egJoltParallelFor(internalInstance->job_system, count, cQueryBatchSize, [&](unsigned int start, unsigned int end)
+		{
+			unsigned int batchHitCount = 0;
+			for (unsigned int i = start; i < end; i++)
+			{
+				if (_egJoltCastRayAtTick(*historyTick, rayCasts[i], results[i]))
+				{
+					batchHitCount++;
+				}
+			}
+			hitCount.fetch_add(batchHitCount, memory_order_relaxed);
+		});
+		return hitCount;
+	}
+
 	/* CHARACTER VIRTUAL */
 
 	EG_EXPORT EgJoltCharacterVirtual egJoltCreateCharacterVirtual(EgJoltInstance instance, EgJoltCharacterSettings& settings, EgJoltVector3 position)
@@ -1157,7 +5032,17 @@ extern "C" {
 
 	EG_EXPORT void egJoltDestroyCharacterVirtual(EgJoltInstance instance, EgJoltCharacterVirtual character)
 	{
-		delete character.internal;
+		auto internal = GetInternalInstance(instance);
+		auto characterVirtual = GetInternalCharacterVirtual(character);
+
+		// Not a character of this instance
+		auto& characterVirtuals = internal->characterVirtuals;
+		auto it = std::find(characterVirtuals.begin(), characterVirtuals.end(), characterVirtual);
+		if (it == characterVirtuals.end())
+			return;
+		characterVirtuals.erase(it);
+
+		delete characterVirtual;
 		character.internal = nullptr;
 	}
 
@@ -1186,7 +5071,17 @@ extern "C" {
 	EG_EXPORT void egJolt_CharacterVirtual_SetPosition(EgJoltInstance instance, EgJoltCharacterVirtual character, EgJoltVector3 position)
 	{
 		auto characterVirtual = GetInternalCharacterVirtual(character);
-		characterVirtual->SetPosition(ConvertVector3(position));
+		characterVirtual->SetPosition(ConvertRVec3(position));
+	}
+
+	EG_EXPORT EgJoltDVector3 egJoltGetCharacterVirtualPositionD(EgJoltInstance instance, EgJoltCharacterVirtual character)
+	{
+		return ConvertDVector3(GetInternalCharacterVirtual(character)->GetPosition());
+	}
+
+	EG_EXPORT void egJolt_CharacterVirtual_SetPositionD(EgJoltInstance instance, EgJoltCharacterVirtual character, EgJoltDVector3 position)
+	{
+		GetInternalCharacterVirtual(character)->SetPosition(ConvertRVec3(position));
 	}
 
 	EG_EXPORT void egJolt_CharacterVirtual_RefreshContacts(EgJoltInstance instance, EgJoltCharacterVirtual character, unsigned char layer)
@@ -1266,28 +5161,12 @@ extern "C" {
 	EG_EXPORT void egJoltUpdateCharacterVirtual(EgJoltInstance instance, EgJoltCharacterVirtual character, float deltaTime, EgJoltCharacterVirtualUpdateSettings& updateSettings)
 	{
 		auto internalInstance = GetInternalInstance(instance);
-		auto characterVirtual = GetInternalCharacterVirtual(character);
-
-		auto physics = internalInstance->physics_system;
+		_egJoltUpdateCharacterVirtual(internalInstance, GetInternalCharacterVirtual(character), deltaTime, updateSettings, *internalInstance->temp_allocator);
+	}
 
-		CharacterVirtual::ExtendedUpdateSettings settings;
-		settings.mStickToFloorStepDown = ConvertVector3(updateSettings.stickToFloorStepDown);
-		settings.mWalkStairsStepUp = ConvertVector3(updateSettings.walkStairsStepUp);
-		settings.mWalkStairsCosAngleForwardContact = updateSettings.walkStairsCosAngleForwardContact;
-		settings.mWalkStairsStepDownExtra = ConvertVector3(updateSettings.walkStairsStepDownExtra);
-		settings.mWalkStairsStepForwardTest = updateSettings.walkStairsStepForwardTest;
-		settings.mWalkStairsMinStepForward = updateSettings.walkStairsMinStepForward;
-
-		characterVirtual->ExtendedUpdate(
-			deltaTime,
-			-characterVirtual->GetUp() * physics->GetGravity().Length(),
-			settings,
-			physics->GetDefaultBroadPhaseLayerFilter(updateSettings.layer),
-			physics->GetDefaultLayerFilter(updateSettings.layer),
-			(*internalInstance->bodyFilter),
-			{ },
-			*internalInstance->temp_allocator
-		);
+	EG_EXPORT void egJoltUpdateCharacterVirtuals(EgJoltInstance instance, const EgJoltCharacterVirtual* characters, unsigned int count, EgJoltCharacterVirtualUpdateSettings& updateSettings, float deltaTime)
+	{
+		_egJoltUpdateCharacterVirtuals(GetInternalInstance(instance), characters, count, updateSettings, deltaTime);
 	}
 
 	EG_EXPORT void egJoltGetCharacterVirtualActiveDynamicContacts(EgJoltInstance instance, EgJoltCharacterVirtual character, void(*callbackContact)(unsigned int))
@@ -1346,7 +5225,17 @@ extern "C" {
 
 	EG_EXPORT void egJoltSetCharacterPosition(EgJoltInstance instance, EgJoltCharacter character, EgJoltVector3 position)
 	{
-		GetInternalCharacter(character)->SetPosition(ConvertVector3(position));
+		GetInternalCharacter(character)->SetPosition(ConvertRVec3(position));
+	}
+
+	EG_EXPORT EgJoltDVector3 egJoltGetCharacterPositionD(EgJoltInstance instance, EgJoltCharacter character)
+	{
+		return ConvertDVector3(GetInternalCharacter(character)->GetPosition());
+	}
+
+	EG_EXPORT void egJoltSetCharacterPositionD(EgJoltInstance instance, EgJoltCharacter character, EgJoltDVector3 position)
+	{
+		GetInternalCharacter(character)->SetPosition(ConvertRVec3(position));
 	}
 
 	EG_EXPORT EgJoltVector3 egJoltGetCharacterLinearVelocity(EgJoltInstance instance, EgJoltCharacter character)
@@ -1382,21 +5271,8 @@ extern "C" {
 		outState->rotation        = ConvertQuaternion(body->GetRotation());
 		outState->linearVelocity  = ConvertVector3(body->GetLinearVelocity());
 		outState->angularVelocity = ConvertVector3(body->GetAngularVelocity());
-
-		EgJolt_BodyFlags flags = EgJolt_BodyFlags_None;
-
-		if (body->IsSensor())
-		{
-			flags = flags | EgJolt_BodyFlags_IsSensor;
-		}
-
-		if (body->IsActive())
-		{
-			flags = flags | EgJolt_BodyFlags_IsActive;
-		}
-
-		outState->flags = flags;
-		outState->layer = body->GetObjectLayer();
+		outState->flags           = _egJolt_Body_GetFlags(body);
+		outState->layer           = body->GetObjectLayer();
 	}
 
 	EG_EXPORT void egJolt_Body_SetState(const EgJoltInstance instance, unsigned int bodyId, const EgJoltBodyState* state)
@@ -1426,6 +5302,115 @@ extern "C" {
 		}
 	}
 
+	EG_EXPORT unsigned int egJolt_Bodies_GetStates(const EgJoltInstance instance, const unsigned int* bodyIds, unsigned int bodyCount, EgJoltBodyStates* states)
+	{
+		const BodyLockInterfaceNoLock& lockInterface = _egJolt_GetBodyLockInterfaceNoLock(instance);
+
+		unsigned int invalidCount = 0;
+		for (unsigned int i = 0; i < bodyCount; i++)
+		{
+			const Body* body = lockInterface.TryGetBody(ConvertBodyId(bodyIds[i]));
+			if (!body)
+			{
+				// Stale ids from replication data get a zeroed slot instead of taking the process down
+				invalidCount++;
+				if (states->positions)
+					states->positions[i] = {};
+				if (states->rotations)
+					states->rotations[i] = {};
+				if (states->linearVelocities)
+					states->linearVelocities[i] = {};
+				if (states->angularVelocities)
+					states->angularVelocities[i] = {};
+				if (states->flags)
+					states->flags[i] = EgJolt_BodyFlags_None;
+				if (states->layers)
+					states->layers[i] = 0;
+				continue;
+			}
+
+			if (states->positions)
+				states->positions[i] = ConvertVector3(body->GetPosition());
+
+			if (states->rotations)
+				states->rotations[i] = ConvertQuaternion(body->GetRotation());
+
+			if (states->linearVelocities)
+				states->linearVelocities[i] = ConvertVector3(body->GetLinearVelocity());
+
+			if (states->angularVelocities)
+				states->angularVelocities[i] = ConvertVector3(body->GetAngularVelocity());
+
+			if (states->flags)
+				states->flags[i] = _egJolt_Body_GetFlags(body);
+
+			if (states->layers)
+				states->layers[i] = body->GetObjectLayer();
+		}
+		return invalidCount;
+	}
+
+	EG_EXPORT unsigned int egJolt_Bodies_SetStates(const EgJoltInstance instance, const unsigned int* bodyIds, unsigned int bodyCount, const EgJoltBodyStates* states)
+	{
+		const BodyLockInterfaceNoLock& lockInterface = _egJolt_GetBodyLockInterfaceNoLock(instance);
+		BodyInterface&                 bodyInterface = _egJolt_GetBodyInterfaceNoLock(instance);
+
+		unsigned int invalidCount = 0;
+		for (unsigned int i = 0; i < bodyCount; i++)
+		{
+			BodyID id   = ConvertBodyId(bodyIds[i]);
+			Body*  body = lockInterface.TryGetBody(id);
+			if (!body)
+			{
+				invalidCount++;
+				continue;
+			}
+
+			if (states->positions || states->rotations)
+			{
+				// Only bodies that actually moved touch the broadphase, which is the common case when rolling back.
+				RVec3 position = states->positions ? ConvertRVec3(states->positions[i]) : body->GetPosition();
+				Quat  rotation = states->rotations ? ConvertQuaternion(states->rotations[i]) : body->GetRotation();
+				bodyInterface.SetPositionAndRotationWhenChanged(id, position, rotation, EActivation::DontActivate);
+			}
+
+			if (states->linearVelocities || states->angularVelocities)
+			{
+				Vec3 linearVelocity  = states->linearVelocities ? Vec3(ConvertVector3(states->linearVelocities[i])) : body->GetLinearVelocity();
+				Vec3 angularVelocity = states->angularVelocities ? Vec3(ConvertVector3(states->angularVelocities[i])) : body->GetAngularVelocity();
+				_Jolt_Body_SetVelocity(body, linearVelocity, angularVelocity);
+			}
+
+			if (states->flags)
+			{
+				bool isSensor = states->flags[i] & EgJolt_BodyFlags_IsSensor;
+				if (body->IsSensor() != isSensor)
+				{
+					body->SetIsSensor(isSensor);
+				}
+
+				bool isActive = states->flags[i] & EgJolt_BodyFlags_IsActive;
+				if (body->IsActive() != isActive)
+				{
+					if (isActive)
+					{
+						bodyInterface.ActivateBody(id);
+					}
+					else
+					{
+						bodyInterface.DeactivateBody(id);
+					}
+				}
+			}
+
+			if (states->layers && body->GetObjectLayer() != states->layers[i])
+			{
+				bodyInterface.SetObjectLayer(id, states->layers[i]);
+			}
+		}
+		return invalidCount;
+	}
+
 	EG_EXPORT int egJolt_Vector3_IsNearZero(EgJoltVector3 v)
 	{
 		return ConvertVector3(v).IsNearZero();
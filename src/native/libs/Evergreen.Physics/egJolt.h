@@ -6,12 +6,23 @@ typedef struct {
 	void* internal;
 } EgJoltInstance;
 
+typedef struct {
+	void* internal;
+} EgJoltJobSystem;
+
 typedef struct {
 	float x;
 	float y;
 	float z;
 } EgJoltVector3;
 
+// Positions for the double precision build (JPH_DOUBLE_PRECISION), also accepted by the single precision build.
+typedef struct {
+	double x;
+	double y;
+	double z;
+} EgJoltDVector3;
+
 typedef struct {
 	float x;
 	float y;
@@ -45,6 +56,75 @@ inline EgJolt_BodyFlags operator|(EgJolt_BodyFlags a, EgJolt_BodyFlags b)
 	return static_cast<EgJolt_BodyFlags>(static_cast<unsigned char>(a) | static_cast<unsigned char>(b));
 }
 
+enum EgJolt_StateFlags : unsigned char
+{
+	EgJolt_StateFlags_None						= 0,
+	EgJolt_StateFlags_ActiveDynamicBodiesOnly	= 1 << 0,
+};
+
+typedef struct {
+	unsigned int maxBodies;
+	unsigned int numBodyMutexes;			// 0 lets Jolt decide
+	unsigned int maxBodyPairs;
+	unsigned int maxContactConstraints;		// Also the capacity of the contact event queue
+	unsigned int tempAllocatorSize;			// Bytes. Steps that need more spill into an overflow arena, after which the allocator grows to fit them
+	int threadCount;						// 0 steps on the shared job system, otherwise the instance gets a job system with this many threads
+	int collisionSteps;						// Used when egJoltUpdate is given 0 collision steps
+	int numVelocitySteps;
+	int numPositionSteps;
+	float baumgarte;
+	float speculativeContactDistance;
+	float penetrationSlop;
+	float timeBeforeSleep;
+	float pointVelocitySleepThreshold;
+	bool allowSleeping;
+	bool deterministicSimulation;
+	unsigned long long staticLayerMask;		// Object layers that only hold static bodies. They share one broadphase tree and all other layers share a second one
+} EgJoltInstanceSettings;
+
+enum EgJolt_UpdateError : unsigned int
+{
+	EgJolt_UpdateError_None						= 0,
+	EgJolt_UpdateError_ManifoldCacheFull		= 1 << 0,	// Contacts were dropped, raise maxContactConstraints
+	EgJolt_UpdateError_BodyPairCacheFull		= 1 << 1,	// Body pairs were dropped, raise maxBodyPairs
+	EgJolt_UpdateError_ContactConstraintsFull	= 1 << 2,	// Contact constraints were dropped, raise maxContactConstraints
+};
+
+typedef struct {
+	EgJolt_UpdateError errors;
+	unsigned int tempAllocatorHighWaterMark;	// Bytes
+	unsigned int activeBodyCount;
+	unsigned int contactCount;					// Contact manifolds added or persisted, summed over the collision steps
+	unsigned int droppedContactEventCount;		// Contact events that did not fit in the contact queue, sensor overlaps do not depend on them
+	float stepMilliseconds;						// Wall time of PhysicsSystem::Update
+	float contactsMilliseconds;					// Wall time of updating the contact pairs and running the contact callbacks
+} EgJoltUpdateStats;
+
+typedef struct {
+	unsigned int bodyId;
+	unsigned long long userData;
+	bool isActive;								// False when the body fell asleep, was deactivated or was removed
+} EgJoltActivationChange;
+
+typedef struct {
+	unsigned int bodyId;						// Lowest body id in the island, names the island the same way in every simulation
+	unsigned int bodyCount;
+	unsigned long long hash;
+} EgJoltIslandHash;
+
+typedef struct {
+	void* internal;
+} EgJoltUpdateHandle;
+
+// Transforms of every non-static body at the end of an asynchronous update. Read only, the arrays are owned by the instance.
+typedef struct {
+	unsigned int frame;							// Counts the asynchronous updates, 0 before the first one finished
+	unsigned int bodyCount;
+	const unsigned int* bodyIds;				// Sorted, so a body can be found with a binary search
+	const EgJoltVector3* positions;
+	const EgJoltQuaternion* rotations;
+} EgJoltTransformSnapshot;
+
 typedef struct {
 	float maxSlopeAngle;
 	float maxStrength;
@@ -73,6 +153,17 @@ typedef struct {
 	float density;
 } EgJoltSphereShapeSettings;
 
+typedef struct {
+	const float* samples;					// sampleCount * sampleCount heights, sample (x, y) is at samples[y * sampleCount + x]. FLT_MAX leaves a hole.
+	unsigned int sampleCount;
+	EgJoltVector3 offset;					// Position of sample (0, 0) at height 0
+	EgJoltVector3 scale;					// Distance between samples in x and y, z scales the heights
+	unsigned int blockSize;					// 2 to 8, larger blocks use less memory but cull less precisely
+	unsigned int bitsPerSample;				// 1 to 8
+	const unsigned char* materialIndices;	// Optional (sampleCount - 1)^2 indices below materialCount, laid out like samples
+	unsigned int materialCount;
+} EgJoltHeightFieldShapeSettings;
+
 typedef struct {
 	void* internal;
 } EgJoltCharacterVirtual;
@@ -81,6 +172,17 @@ typedef struct {
 	void* internal;
 } EgJoltCharacter;
 
+typedef struct {
+	void* internal;
+} EgJoltBodyPool;
+
+enum EgJolt_ContactEvent : unsigned char
+{
+	EgJolt_ContactEvent_Added		= 0,
+	EgJolt_ContactEvent_Persisted	= 1,
+	EgJolt_ContactEvent_Removed		= 2,
+};
+
 typedef struct {
 	unsigned int bodyId1;
 	unsigned long long userData1;
@@ -88,8 +190,29 @@ typedef struct {
 	unsigned int bodyId2;
 	unsigned long long userData2;
 	EgJoltVector3 point2;
+	EgJoltVector3 normal;				// World space, pointing from body 1 to body 2
+	float penetrationDepth;
+	unsigned int pointCount;			// Removed events only carry the body ids, everything else is zero
+	EgJoltVector3 points1[4];
+	EgJoltVector3 points2[4];
+	EgJolt_ContactEvent contactEvent;
 } EgJoltContactArgs;
 
+enum EgJolt_TriggerEvent : unsigned char
+{
+	EgJolt_TriggerEvent_Enter	= 0,
+	EgJolt_TriggerEvent_Exit	= 1,
+};
+
+typedef struct {
+	unsigned int sensorBodyId;
+	unsigned long long sensorUserData;
+	unsigned int otherBodyId;			// May no longer exist for exit events
+	unsigned long long otherUserData;
+	unsigned char otherLayer;
+	EgJolt_TriggerEvent triggerEvent;
+} EgJoltTriggerArgs;
+
 typedef struct {
 	unsigned int vertexCount;
 	EgJoltVector3* vertices;
@@ -105,6 +228,136 @@ typedef struct {
 	EgJoltMesh* meshes;
 } EgJoltCompoundMesh;
 
+typedef struct {
+	const EgJoltVector3* points;
+	unsigned int pointCount;
+	unsigned int maxVertexCount;		// 0 for no limit
+	float density;
+} EgJoltConvexHullShapeSettings;
+
+typedef struct {
+	unsigned int maxHulls;
+	unsigned int maxVerticesPerHull;	// 0 for no limit
+	float maxConcavity;					// How far the surface of a hull may lie outside of the mesh before the part is split further, negative values are treated as 0
+	float density;
+} EgJoltConvexDecompositionSettings;
+
+typedef struct {
+	unsigned int shapeCount;
+	unsigned long long hitCount;			// Bodies that got an already registered shape
+	unsigned long long missCount;			// Bodies that had to build a new shape
+	unsigned long long memoryBytes;			// Memory used by the registered shapes
+	unsigned long long savedMemoryBytes;	// Memory the bodies would use on top of that if every body had its own shape
+} EgJoltShapeRegistryStats;
+
+typedef struct {
+	unsigned long long heapBytes;				// Allocated through Jolt's allocator by all instances and shapes
+	unsigned long long heapPeakBytes;			// Most heap bytes allocated at once since egJoltSharedInit
+	unsigned long long heapAllocationCount;		// Heap allocations since egJoltSharedInit
+	unsigned int allHeapAllocationsDuringStep;	// Heap allocations of the whole process while the last step of this instance ran, other instances and threads included
+	unsigned int tempAllocatorSize;				// Bytes of the main arena
+	unsigned int tempAllocatorPeakBytes;		// Most temp bytes in use at once since the instance was created, overflow included
+	unsigned int tempAllocatorOverflowCount;	// Temp allocations that did not fit in the main arena since the instance was created
+} EgJoltMemoryStats;
+
+enum EgJolt_QueryFlags : unsigned char
+{
+	EgJolt_QueryFlags_None		= 0,
+	EgJolt_QueryFlags_AnyHit	= 1 << 0,	// Stop at the first hit found instead of looking for the closest one
+	EgJolt_QueryFlags_BoundsOnly	= 1 << 1,	// Overlap queries only test the bounding boxes of the bodies in the broadphase, which is cheaper but not exact
+};
+
+typedef struct {
+	EgJoltVector3 origin;
+	EgJoltVector3 direction;			// Normalized
+	float maxDistance;
+	unsigned long long layerMask;		// Bit N set = object layer N can be hit
+	unsigned int ignoreBodyId;			// 0xFFFFFFFF to not ignore any body
+	EgJolt_QueryFlags flags;
+} EgJoltRayCast;
+
+typedef struct {
+	unsigned int bodyId;				// 0xFFFFFFFF when nothing was hit
+	unsigned long long userData;
+	EgJoltVector3 position;
+	EgJoltVector3 normal;
+	float distance;
+	bool hasHit;
+} EgJoltRayCastResult;
+
+typedef struct {
+	EgJoltVector3 center;
+	float radius;
+	unsigned long long layerMask;		// Bit N set = object layer N can be hit
+	EgJolt_QueryFlags flags;
+} EgJoltSphereOverlap;
+
+typedef struct {
+	EgJoltVector3 center;
+	EgJoltQuaternion rotation;
+	EgJoltVector3 halfExtents;
+	unsigned long long layerMask;		// Bit N set = object layer N can be hit
+	EgJolt_QueryFlags flags;
+} EgJoltBoxOverlap;
+
+typedef struct {
+	unsigned int bodyId;
+	unsigned long long userData;
+} EgJoltOverlapHit;
+
+typedef struct {
+	EgJoltShape shape;
+	EgJoltVector3 position;
+	EgJoltQuaternion rotation;
+	EgJoltVector3 direction;			// Normalized
+	float maxDistance;
+	unsigned long long layerMask;		// Bit N set = object layer N can be hit
+	unsigned int ignoreBodyId;			// 0xFFFFFFFF to not ignore any body
+	EgJolt_QueryFlags flags;
+} EgJoltShapeCast;
+
+typedef struct {
+	unsigned int bodyId;				// 0xFFFFFFFF when nothing was hit
+	unsigned long long userData;
+	EgJoltVector3 position;				// Contact point on the hit body
+	EgJoltVector3 normal;				// Pointing towards the cast shape
+	float distance;
+	float penetrationDepth;				// Only non-zero when the shape already overlaps at the start of the cast
+	bool hasHit;
+} EgJoltShapeCastResult;
+
+enum EgJolt_MotionQuality : unsigned char
+{
+	EgJolt_MotionQuality_Discrete	= 0,	// Cheapest, fast bodies can tunnel through thin geometry
+	EgJolt_MotionQuality_LinearCast	= 1,	// Continuous collision detection, for projectiles and other fast bodies
+};
+
+enum EgJolt_AllowedDOFs : unsigned char
+{
+	EgJolt_AllowedDOFs_None			= 0,		// Same as All
+	EgJolt_AllowedDOFs_TranslationX	= 1 << 0,
+	EgJolt_AllowedDOFs_TranslationY	= 1 << 1,
+	EgJolt_AllowedDOFs_TranslationZ	= 1 << 2,
+	EgJolt_AllowedDOFs_RotationX	= 1 << 3,
+	EgJolt_AllowedDOFs_RotationY	= 1 << 4,
+	EgJolt_AllowedDOFs_RotationZ	= 1 << 5,
+	EgJolt_AllowedDOFs_All			= 0x3F,
+};
+
+// Properties that are fixed when a body is created. egJoltGetDefaultBodyCreationOptions gives what bodies get when no options are passed,
+// except that static bodies get Discrete motion quality; start from it rather than from zeroed options, where friction 0 is a valid value and makes bodies slide.
+typedef struct {
+	EgJolt_MotionQuality motionQuality;
+	bool enhancedInternalEdgeRemoval;		// Removes ghost collisions with internal mesh edges, at some cost for every contact
+	EgJolt_AllowedDOFs allowedDOFs;
+	float friction;
+	float restitution;
+	float linearDamping;
+	float angularDamping;
+	float maxLinearVelocity;				// m/s, 0 for the default
+	float maxAngularVelocity;				// rad/s, 0 for the default
+} EgJoltBodyCreationOptions;
+
 typedef struct {
 	EgJoltVector3 position;
 	EgJoltQuaternion rotation;
@@ -115,6 +368,18 @@ typedef struct {
 	unsigned char layer;
 } EgJoltBodyState;
 
+// Structure-of-arrays view over caller-owned body state arrays.
+// Every array is indexed the same as the body id array passed alongside it.
+// Any array may be null, in which case that part of the state is skipped.
+typedef struct {
+	EgJoltVector3* positions;
+	EgJoltQuaternion* rotations;
+	EgJoltVector3* linearVelocities;
+	EgJoltVector3* angularVelocities;
+	EgJolt_BodyFlags* flags;
+	unsigned char* layers;
+} EgJoltBodyStates;
+
 typedef struct
 {
 	EgJoltVector3			stickToFloorStepDown;
@@ -140,47 +405,178 @@ extern "C" {
 	EG_EXPORT void egJoltSharedInit();
 	EG_EXPORT void egJoltSharedDestroy();
 
+	// threadCount < 0 uses one worker per core minus the calling thread. affinityMask = 0 leaves scheduling to the OS,
+	// otherwise worker N is pinned to the N-th core set in the mask. maxInstances is how many instances can step on the
+	// job system at the same time before their jobs start running on the stepping thread, 0 counts as 1.
+	EG_EXPORT EgJoltJobSystem egJoltCreateJobSystem(int threadCount, unsigned long long affinityMask, unsigned int maxInstances);
+	EG_EXPORT void egJoltDestroyJobSystem(EgJoltJobSystem jobSystem);
+	// Created by egJoltSharedInit, every new instance steps on it.
+	EG_EXPORT EgJoltJobSystem egJoltGetDefaultJobSystem();
+	EG_EXPORT int egJoltJobSystemGetMaxConcurrency(EgJoltJobSystem jobSystem);
+	// Calls callback for [start, end) ranges of at most batchSize items across the job system and returns when all are done.
+	EG_EXPORT void egJoltJobSystemParallelFor(EgJoltJobSystem jobSystem, unsigned int count, unsigned int batchSize, void(*callback)(void* userData, unsigned int start, unsigned int end), void* userData);
+
 	EG_EXPORT unsigned int egJoltGetMaxBodies();
 	EG_EXPORT unsigned int egJoltGetMaxBodyPairs();
 	EG_EXPORT unsigned int egJoltGetMaxContactConstraints();
+	EG_EXPORT unsigned int egJoltGetMaxLayers();
+	// True for the ReleaseDouble and DebugDouble builds, which simulate positions in double precision (JPH_DOUBLE_PRECISION).
+	EG_EXPORT bool egJoltIsDoublePrecision();
+	EG_EXPORT EgJoltInstanceSettings egJoltGetDefaultInstanceSettings();
 
+	// callbackShouldCollide is asked once for every pair of layers while the instance is created and never again. Later changes in its answers
+	// are ignored until they are passed to egJoltSetLayerCollisionMatrix. Null lets every layer collide with every other layer.
 	EG_EXPORT EgJoltInstance egJoltCreateInstance(
 		unsigned char maxNumberOfLayers,
 		void(*callbackContactAdded)(EgJoltContactArgs),
 		void(*callbackContactPersisted)(EgJoltContactArgs),
-		bool(*callbackShouldCollide)(unsigned char layer1, unsigned char layer2)
+		bool(*callbackShouldCollide)(unsigned char layer1, unsigned char layer2),
+		const EgJoltInstanceSettings* settings		// Null uses egJoltGetDefaultInstanceSettings
 	);
 	EG_EXPORT void egJoltDestroyInstance(EgJoltInstance instance);
-	EG_EXPORT void egJoltUpdate(EgJoltInstance instance, float deltaTime, int collisionSteps);
+	EG_EXPORT EgJoltUpdateStats egJoltUpdate(EgJoltInstance instance, float deltaTime, int collisionSteps);
+	// Starts the update on the instance's job system and returns right away. The handle is null when an update is already in flight.
+	// Until egJoltWaitUpdate returns, the instance may only be used through egJoltIsUpdateComplete and egJoltGetTransformSnapshot.
+	// Contact callbacks run in egJoltWaitUpdate on the calling thread. Without worker threads the step runs before egJoltUpdateAsync returns.
+	EG_EXPORT EgJoltUpdateHandle egJoltUpdateAsync(EgJoltInstance instance, float deltaTime, int collisionSteps);
+	EG_EXPORT bool egJoltIsUpdateComplete(EgJoltUpdateHandle handle);
+	EG_EXPORT EgJoltUpdateStats egJoltWaitUpdate(EgJoltUpdateHandle handle);
+	// Jolt's heap is shared by every instance, so the heap counters cover the whole process. Must not be called while the instance is updating.
+	EG_EXPORT EgJoltMemoryStats egJoltGetMemoryStats(EgJoltInstance instance);
+	// The snapshot of the last finished asynchronous update. Safe to read from any thread while the next update runs;
+	// it is overwritten at the end of the update after that, or by egJoltShiftOrigin. egJoltUpdate does not write snapshots.
+	EG_EXPORT EgJoltTransformSnapshot egJoltGetTransformSnapshot(EgJoltInstance instance);
+	// Must not be called while the instance is updating.
+	EG_EXPORT void egJoltSetJobSystem(EgJoltInstance instance, EgJoltJobSystem jobSystem);
 	EG_EXPORT void egJoltSetGravity(EgJoltInstance instance, EgJoltVector3 gravity);
 	EG_EXPORT void egJoltOptimizeBroadPhase(EgJoltInstance instance);
 
+	// masks[N] has bit M set when object layer N collides with object layer M. Can be changed between steps.
+	EG_EXPORT void egJoltSetLayerCollisionMatrix(EgJoltInstance instance, const unsigned long long* masks, unsigned int count);
+	// Maps object layers to broadphase layers, replacing the split given by staticLayerMask. Only allowed before any body is added.
+	EG_EXPORT bool egJoltSetBroadPhaseLayers(EgJoltInstance instance, const unsigned char* broadPhaseLayers, unsigned int count);
+
+	// Contact events of the last egJoltUpdate. When contact callbacks were given to egJoltCreateInstance, egJoltUpdate hands the events to them instead
+	// and egJoltDrainContacts returns nothing; removed events are then not reported at all.
+	EG_EXPORT unsigned int egJoltDrainContacts(EgJoltInstance instance, EgJoltContactArgs* buffer, unsigned int capacity);
+	// Starting capacity of the contact queue, twice the maximum number of contact constraints by default.
+	// A step that produces more events drops the rest (see droppedContactEventCount) and the queue grows to fit them before the next step.
+	EG_EXPORT void egJoltSetContactQueueCapacity(EgJoltInstance instance, unsigned int capacity);
+	// Bodies that started or stopped overlapping a sensor during the last update, only those on the layers in layerMask.
+	// Copies at most capacity events and returns the full count. Overlaps are tracked apart from the contact queue and are not affected by dropped contact events.
+	// A body that falls asleep inside a sensor stays inside until it is removed, or wakes up and no longer touches the sensor.
+	EG_EXPORT unsigned int egJoltGetTriggerEvents(EgJoltInstance instance, unsigned long long layerMask, EgJoltTriggerArgs* events, unsigned int capacity);
+
+	// Bodies the last egJoltUpdate could have moved: the ones awake after it and the ones that fell asleep during it, sorted by id.
+	// Bodies that were only moved by setting their position are not included. Both functions copy at most capacity entries and return the full count.
+	EG_EXPORT unsigned int egJoltGetActiveBodies(EgJoltInstance instance, unsigned int* bodyIds, unsigned int capacity);
+	// Activations and deactivations in the order they happened, from the end of the egJoltUpdate before the last one to the end of the last one.
+	EG_EXPORT unsigned int egJoltGetActivationChanges(EgJoltInstance instance, EgJoltActivationChange* changes, unsigned int capacity);
+
+	// Returns the number of bytes the state needs. Nothing is written if the buffer is null; if it is too small, only the part that fits is written and the buffer must not be restored.
+	EG_EXPORT unsigned int egJoltSaveState(EgJoltInstance instance, EgJolt_StateFlags flags, void* buffer, unsigned int bufferSize);
+	EG_EXPORT bool egJoltRestoreState(EgJoltInstance instance, const void* buffer, unsigned int bufferSize);
+	EG_EXPORT void egJoltSetStateHistoryCapacity(EgJoltInstance instance, unsigned int frameCount);
+	EG_EXPORT unsigned int egJoltSaveStateToHistory(EgJoltInstance instance, unsigned int frame, EgJolt_StateFlags flags);
+	EG_EXPORT bool egJoltRestoreStateFromHistory(EgJoltInstance instance, unsigned int frame);
+	// Hash of the positions, rotations and velocities of the active bodies on the layers in layerMask. Equal between simulations that
+	// assigned the same body ids and stepped the same way. islandHashes may be null; islandCount receives the number of islands, which
+	// can be more than islandCapacity. Must not be called while the instance is updating.
+	EG_EXPORT unsigned long long egJoltComputeStateHash(EgJoltInstance instance, unsigned long long layerMask, EgJoltIslandHash* islandHashes, unsigned int islandCapacity, unsigned int* islandCount);
+
 	EG_EXPORT bool egJoltCreateBoxShape(EgJoltBoxShapeSettings settings, EgJoltShape* outShape);
 	EG_EXPORT bool egJoltCreateSphereShape(EgJoltSphereShapeSettings settings, EgJoltShape* outShape);
 	EG_EXPORT bool egJoltCreateMeshShape(EgJoltVector3* vertices, int vertexLength, unsigned int* indices, int indexLength, EgJoltShape* outShape);
 	EG_EXPORT bool egJoltCreateCompoundShape(EgJoltShape* shapes, int shapeCount, EgJoltShape* outShape);
 	EG_EXPORT bool egJoltDestroyShape(EgJoltShape shape);
-
-	EG_EXPORT bool egJoltCreateStaticBody(EgJoltInstance instance, EgJoltShape shape, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state);
-	EG_EXPORT bool egJoltCreateDynamicBody(EgJoltInstance instance, EgJoltShape shape, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state);
+	EG_EXPORT bool egJoltCreateConvexHullShape(EgJoltConvexHullShapeSettings settings, EgJoltShape* outShape);
+	// Approximates the mesh with convex hulls for use on dynamic bodies. Slow, meant to run when importing assets; cache the result with egJoltSaveShape.
+	EG_EXPORT bool egJoltCreateConvexDecompositionShape(EgJoltMesh mesh, EgJoltConvexDecompositionSettings settings, EgJoltShape* outShape);
+	// Height field shapes are never shared, so each body that uses one can change its heights on its own.
+	EG_EXPORT bool egJoltCreateHeightFieldShape(EgJoltHeightFieldShapeSettings settings, EgJoltShape* outShape);
+	// x, y, sizeX and sizeY must be multiples of the block size. heights holds sizeX * sizeY samples. Not safe to call while the instance is updating or queried.
+	EG_EXPORT bool egJoltSetHeightFieldHeights(EgJoltInstance instance, unsigned int bodyId, unsigned int x, unsigned int y, unsigned int sizeX, unsigned int sizeY, const float* heights);
+	// Box, sphere and character shapes of bodies are shared through a registry keyed by their parameters. Mesh shapes are not shared.
+	EG_EXPORT EgJoltShapeRegistryStats egJoltGetShapeRegistryStats();
+	// Releases registered shapes that are no longer used by any body and returns how many were released.
+	EG_EXPORT unsigned int egJoltPruneShapeRegistry();
+	EG_EXPORT bool egJoltCreateCompoundMeshShape(EgJoltCompoundMesh compoundMesh, EgJoltShape* outShape);
+
+	// Content hashes of the input geometry. Pass the hash to egJoltSaveShape and egJoltLoadShapeFromMemory to tell when a cached shape is stale.
+	EG_EXPORT unsigned long long egJoltHashMesh(const EgJoltVector3* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	EG_EXPORT unsigned long long egJoltHashCompoundMesh(EgJoltCompoundMesh compoundMesh);
+	// Writes the built shape, including its children, as a versioned blob. Returns the blob size; nothing is written when buffer is null or too small.
+	EG_EXPORT unsigned int egJoltSaveShape(EgJoltShape shape, unsigned long long contentHash, void* buffer, unsigned int bufferSize);
+	// Fails when the blob is corrupt, was written by another version or build configuration, or its content hash does not match.
+	EG_EXPORT bool egJoltLoadShapeFromMemory(const void* buffer, unsigned int bufferSize, unsigned long long contentHash, EgJoltShape* outShape);
+
+	EG_EXPORT EgJoltBodyCreationOptions egJoltGetDefaultBodyCreationOptions();
+	// options may be null for the defaults.
+	EG_EXPORT bool egJoltCreateStaticBody(EgJoltInstance instance, EgJoltShape shape, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options);
+	EG_EXPORT bool egJoltCreateDynamicBody(EgJoltInstance instance, EgJoltShape shape, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options);
+
+	// Adds all bodies to the broadphase as one batch and optimizes the broadphase afterwards. userData and options may be null, otherwise they hold one entry per body.
+	// bodyIds holds the id to create each body with, like the bodyId of egJoltCreateStaticBody, or 0xFFFFFFFF to let Jolt pick one.
+	// It receives the id of each body, 0xFFFFFFFF where the body could not be created or its id was taken. Returns the number of bodies created.
+	// masses must not be null for dynamic bodies, nothing is created then.
+	EG_EXPORT unsigned int egJoltCreateStaticBodies(EgJoltInstance instance, const EgJoltShape* shapes, const unsigned long long* userData, const EgJoltBodyState* states, const EgJoltBodyCreationOptions* options, unsigned int count, unsigned int* bodyIds);
+	EG_EXPORT unsigned int egJoltCreateDynamicBodies(EgJoltInstance instance, const EgJoltShape* shapes, const float* masses, const unsigned long long* userData, const EgJoltBodyState* states, const EgJoltBodyCreationOptions* options, unsigned int count, unsigned int* bodyIds);
+
+	// Writes every body on a layer in layerMask, with its shape, material and user data, as one versioned blob. Shapes shared between bodies are written once.
+	// Returns the blob size; nothing is written when buffer is null or too small. Layers of characters and pooled bodies should be left out of layerMask.
+	EG_EXPORT unsigned int egJoltExportScene(EgJoltInstance instance, unsigned long long layerMask, void* buffer, unsigned int bufferSize);
+	// Number of bodies in an exported scene, 0 when the blob header is not valid. Use it to size bodyIds for egJoltImportScene.
+	EG_EXPORT unsigned int egJoltGetSceneBodyCount(const void* buffer, unsigned int bufferSize);
+	// Creates the bodies of an exported scene and adds them to the broadphase as one batch. Bodies keep their exported ids unless these are taken.
+	// bodyIds may be null, otherwise it receives up to bodyIdCapacity ids in export order. bodyCount may be null, otherwise it receives the number of bodies in the scene.
+	// Fails when the blob is corrupt, was written by another version or build configuration, or not every body could be created. Nothing is added to the world then.
+	EG_EXPORT bool egJoltImportScene(EgJoltInstance instance, const void* buffer, unsigned int bufferSize, unsigned int* bodyIds, unsigned int bodyIdCapacity, unsigned int* bodyCount);
+
+	// Pools of pre-created dynamic bodies for projectiles and debris. Parked bodies stay out of the broadphase but keep their id, and every pool body counts towards the max body count.
+	// Acquired and released bodies enter and leave the world in one batch at the next egJoltFlushBodyPools or update, so a released body can still be hit by queries until then.
+	// Pooled bodies must be returned with egJoltReleasePooledBody, never removed with egJoltRemoveBody; one that is removed anyway is dropped from its pool.
+	// Not safe to call while an asynchronous update is in flight.
+	EG_EXPORT EgJoltBodyPool egJoltCreateBodyPool(EgJoltInstance instance, EgJoltShape shape, float mass, const EgJoltBodyCreationOptions* options, unsigned int count);
+	EG_EXPORT void egJoltDestroyBodyPool(EgJoltInstance instance, EgJoltBodyPool pool);
+	EG_EXPORT unsigned int egJoltGetBodyPoolFreeCount(EgJoltBodyPool pool);
+	// Returns 0xFFFFFFFF when the pool is empty.
+	EG_EXPORT unsigned int egJoltAcquirePooledBody(EgJoltInstance instance, EgJoltBodyPool pool, unsigned long long userData, const EgJoltBodyState* state);
+	// Returns false when the body does not belong to the pool or is already released.
+	EG_EXPORT bool egJoltReleasePooledBody(EgJoltInstance instance, EgJoltBodyPool pool, unsigned int bodyId);
+	EG_EXPORT void egJoltFlushBodyPools(EgJoltInstance instance);
 
 	EG_EXPORT unsigned int egJoltGetCharacterBodyId(EgJoltInstance instance, EgJoltCharacter character);
+	// Answers from the contacts of the last egJoltUpdate, bodies moved since then are not taken into account.
+	// After an update that dropped contact events (droppedContactEventCount), pairs that separated during it are still reported until the next update.
 	EG_EXPORT bool egJoltAreBodiesColliding(EgJoltInstance instance, unsigned int bodyId1, unsigned int bodyId2);
+	// Returns how many of the pairs are colliding.
+	EG_EXPORT unsigned int egJoltAreBodiesCollidingMany(EgJoltInstance instance, const unsigned int* bodyIds1, const unsigned int* bodyIds2, unsigned int count, bool* results);
 	EG_EXPORT void egJolt_Body_InvalidateContactCache(EgJoltInstance instance, unsigned int bodyId);
 	EG_EXPORT void egJoltBodySetGravityFactor(EgJoltInstance instance, unsigned int bodyId, float gravityFactor);
-	EG_EXPORT unsigned int egJoltAddBodyDynamicBox(EgJoltInstance instance, EgJoltVector3 scale, float density, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state);
-	EG_EXPORT unsigned int egJoltAddBodyDynamicSphere(EgJoltInstance instance, float radius, float density, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state);
-	EG_EXPORT unsigned int egJoltAddBodyStaticBox(EgJoltInstance instance, EgJoltVector3 scale, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state);
-	EG_EXPORT unsigned int egJoltAddBodyStaticMesh(EgJoltInstance instance, EgJoltVector3* vertices, int vertexCount, unsigned int* indices, int indexCount, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state);
-	EG_EXPORT unsigned int egJoltAddBodyStaticCompoundMesh(EgJoltInstance instance, EgJoltCompoundMesh compoundMesh, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state);
+	// options may be null for the defaults.
+	EG_EXPORT unsigned int egJoltAddBodyDynamicBox(EgJoltInstance instance, EgJoltVector3 scale, float density, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options);
+	EG_EXPORT unsigned int egJoltAddBodyDynamicSphere(EgJoltInstance instance, float radius, float density, float mass, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options);
+	EG_EXPORT unsigned int egJoltAddBodyStaticBox(EgJoltInstance instance, EgJoltVector3 scale, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options);
+	EG_EXPORT unsigned int egJoltAddBodyStaticMesh(EgJoltInstance instance, EgJoltVector3* vertices, int vertexCount, unsigned int* indices, int indexCount, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options);
+	EG_EXPORT unsigned int egJoltAddBodyStaticCompoundMesh(EgJoltInstance instance, EgJoltCompoundMesh compoundMesh, unsigned long long userData, unsigned int* bodyId, EgJoltBodyState* state, const EgJoltBodyCreationOptions* options);
 	EG_EXPORT void egJoltActivateBody(EgJoltInstance instance, unsigned int bodyId);
 	EG_EXPORT void egJoltDeactivateBody(EgJoltInstance instance, unsigned int bodyId);
 	EG_EXPORT void egJoltRemoveBody(EgJoltInstance instance, unsigned int bodyId);
+	EG_EXPORT void egJoltRemoveBodies(EgJoltInstance instance, const unsigned int* bodyIds, unsigned int bodyCount);
 	EG_EXPORT bool egJoltIsBodyActive(EgJoltInstance instance, unsigned int bodyId);
 	EG_EXPORT void egJoltAddBodyImpulse(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 impulse);
 	EG_EXPORT void egJoltAddBodyAngularImpulse(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 angularImpulse);
 	EG_EXPORT unsigned long long egJoltGetBodyUserData(EgJoltInstance instance, unsigned int bodyId);
 	EG_EXPORT void egJoltSetBodyUserData(EgJoltInstance instance, unsigned int bodyId, unsigned long long userData);
+	// Moves every body, character, recorded lag compensation tick and transform snapshot by -offset, without waking bodies or losing contacts.
+	// Lets a single precision build keep the simulation near the origin on large maps. Not safe to call while an asynchronous update is in flight.
+	// The shifted transform snapshot is published as a new snapshot, the one published before stays readable until the next update or shift.
+	EG_EXPORT void egJoltShiftOrigin(EgJoltInstance instance, EgJoltDVector3 offset);
+	// Full precision positions for the double precision build. The single precision build rounds them to float.
+	EG_EXPORT void egJoltSetBodyPositionD(EgJoltInstance instance, unsigned int bodyId, EgJoltDVector3 position);
+	EG_EXPORT EgJoltDVector3 egJoltGetBodyPositionD(EgJoltInstance instance, unsigned int bodyId);
+	EG_EXPORT void egJoltSetBodyPositionAndRotationD(EgJoltInstance instance, unsigned int bodyId, EgJoltDVector3 position, EgJoltQuaternion rotation);
+	EG_EXPORT void egJoltGetBodyPositionAndRotationD(EgJoltInstance instance, unsigned int bodyId, EgJoltDVector3& position, EgJoltQuaternion& rotation);
 	EG_EXPORT void egJoltSetBodyPosition(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 position);
 	EG_EXPORT void egJoltSetBodyPositionAndRotationAndVelocity(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 position, EgJoltQuaternion rotation, EgJoltVector3 linearVelocity, EgJoltVector3 angularVelocity);
 	EG_EXPORT void egJoltSetBodyPositionAndVelocity(EgJoltInstance instance, unsigned int bodyId, EgJoltVector3 position, EgJoltVector3 linearVelocity, EgJoltVector3 angularVelocity);
@@ -199,6 +595,8 @@ extern "C" {
 	EG_EXPORT EgJoltVector3 egJoltGetCharacterVirtualCenterOfMassPosition(EgJoltInstance instance, EgJoltCharacterVirtual character);
 	EG_EXPORT EgJoltVector3 egJoltGetCharacterVirtualPosition(EgJoltInstance instance, EgJoltCharacterVirtual character);
 	EG_EXPORT void egJolt_CharacterVirtual_SetPosition(EgJoltInstance instance, EgJoltCharacterVirtual character, EgJoltVector3 position);
+	EG_EXPORT EgJoltDVector3 egJoltGetCharacterVirtualPositionD(EgJoltInstance instance, EgJoltCharacterVirtual character);
+	EG_EXPORT void egJolt_CharacterVirtual_SetPositionD(EgJoltInstance instance, EgJoltCharacterVirtual character, EgJoltDVector3 position);
 	EG_EXPORT void egJolt_CharacterVirtual_RefreshContacts(EgJoltInstance instance, EgJoltCharacterVirtual character, unsigned char layer);
 	EG_EXPORT EgJoltVector3 egJoltGetCharacterVirtualLinearVelocity(EgJoltInstance instance, EgJoltCharacterVirtual character);
 	EG_EXPORT void egJoltSetCharacterVirtualLinearVelocity(EgJoltInstance instance, EgJoltCharacterVirtual character, EgJoltVector3 linearVelocity);
@@ -209,6 +607,8 @@ extern "C" {
 	EG_EXPORT void egJolt_CharacterVirtual_SetUp(EgJoltInstance instance, EgJoltCharacterVirtual character, EgJoltVector3 up);
 	EG_EXPORT void egJoltUpdateCharacterVirtualGroundVelocity(EgJoltInstance instance, EgJoltCharacterVirtual character);
 	EG_EXPORT void egJoltUpdateCharacterVirtual(EgJoltInstance instance, EgJoltCharacterVirtual character, float deltaTime, EgJoltCharacterVirtualUpdateSettings& updateSettings);
+	// Updates the characters in parallel on the instance's job system. Characters in the batch collide with each other.
+	EG_EXPORT void egJoltUpdateCharacterVirtuals(EgJoltInstance instance, const EgJoltCharacterVirtual* characters, unsigned int count, EgJoltCharacterVirtualUpdateSettings& updateSettings, float deltaTime);
 	EG_EXPORT void egJoltGetCharacterVirtualActiveDynamicContacts(EgJoltInstance instance, EgJoltCharacterVirtual character, void(*callbackContact)(unsigned int));
 
 	EG_EXPORT EgJoltCharacter egJoltCreateCharacter(EgJoltInstance instance, EgJoltCharacterSettings& settings, EgJoltVector3 position, unsigned long long userData);
@@ -217,6 +617,8 @@ extern "C" {
 	EG_EXPORT EgJoltVector3 egJoltGetCharacterCenterOfMassPosition(EgJoltInstance instance, EgJoltCharacter character);
 	EG_EXPORT EgJoltVector3 egJoltGetCharacterPosition(EgJoltInstance instance, EgJoltCharacter character);
 	EG_EXPORT void egJoltSetCharacterPosition(EgJoltInstance instance, EgJoltCharacter character, EgJoltVector3 position);
+	EG_EXPORT EgJoltDVector3 egJoltGetCharacterPositionD(EgJoltInstance instance, EgJoltCharacter character);
+	EG_EXPORT void egJoltSetCharacterPositionD(EgJoltInstance instance, EgJoltCharacter character, EgJoltDVector3 position);
 	EG_EXPORT EgJoltVector3 egJoltGetCharacterLinearVelocity(EgJoltInstance instance, EgJoltCharacter character);
 	EG_EXPORT void egJoltSetCharacterLinearVelocity(EgJoltInstance instance, EgJoltCharacter character, EgJoltVector3 linearVelocity);
 	EG_EXPORT EgJoltVector3 egJoltGetCharacterGroundVelocity(EgJoltInstance instance, EgJoltCharacter character);
@@ -226,6 +628,30 @@ extern "C" {
 	EG_EXPORT void egJolt_Body_GetState(const EgJoltInstance instance, const unsigned int bodyId, EgJoltBodyState* state);
 	EG_EXPORT void egJolt_Body_SetState(const EgJoltInstance instance, unsigned int bodyId, const EgJoltBodyState* state);
 
+	// Ids of bodies that no longer exist are skipped, their slots are zeroed when getting. Both return how many ids were skipped.
+	EG_EXPORT unsigned int egJolt_Bodies_GetStates(const EgJoltInstance instance, const unsigned int* bodyIds, unsigned int bodyCount, EgJoltBodyStates* states);
+	EG_EXPORT unsigned int egJolt_Bodies_SetStates(const EgJoltInstance instance, const unsigned int* bodyIds, unsigned int bodyCount, const EgJoltBodyStates* states);
+
+	// Results are written at the same index as their query. Returns the number of queries that hit something.
+	// Large batches are spread over the instance's job system. Must not be called while the instance is updating.
+	EG_EXPORT unsigned int egJoltCastRays(EgJoltInstance instance, const EgJoltRayCast* rayCasts, unsigned int count, EgJoltRayCastResult* results);
+	EG_EXPORT unsigned int egJoltCastShapes(EgJoltInstance instance, const EgJoltShapeCast* shapeCasts, unsigned int count, EgJoltShapeCastResult* results);
+	// Finds the bodies inside each volume. The hits of query i are hits[hitOffsets[i]] up to hits[hitOffsets[i + 1]], sorted by body id, so hitOffsets needs count + 1 entries.
+	// Returns the total number of hits. Only the first hitCapacity hits are written, the offsets are always complete so the call can be repeated with a larger buffer.
+	// Several threads may run overlap batches on one instance at the same time.
+	EG_EXPORT unsigned int egJoltOverlapSpheres(EgJoltInstance instance, const EgJoltSphereOverlap* overlaps, unsigned int count, EgJoltOverlapHit* hits, unsigned int hitCapacity, unsigned int* hitOffsets);
+	EG_EXPORT unsigned int egJoltOverlapBoxes(EgJoltInstance instance, const EgJoltBoxOverlap* overlaps, unsigned int count, EgJoltOverlapHit* hits, unsigned int hitCapacity, unsigned int* hitOffsets);
+
+	// Lag compensation for hitscan shots on the server. The poses of a tagged set of bodies, e.g. characters and hitboxes, are kept for the last tickCount recorded ticks.
+	// Shots are tested against the poses of the tick the client saw through a small tree built per tick, the live world is not rewound.
+	EG_EXPORT void egJoltSetLagCompensationCapacity(EgJoltInstance instance, unsigned int tickCount);
+	// Replaces the tagged bodies. Takes effect at the next recorded tick, ticks recorded before keep the bodies they had.
+	EG_EXPORT void egJoltSetLagCompensatedBodies(EgJoltInstance instance, const unsigned int* bodyIds, unsigned int count);
+	// Records the current poses as tick, overwriting the oldest tick. Returns false when the capacity is 0.
+	EG_EXPORT bool egJoltRecordLagCompensationTick(EgJoltInstance instance, unsigned int tick);
+	// Like egJoltCastRays, but only the tagged bodies as they were at tick can be hit. Nothing is hit when tick is no longer in the history.
+	EG_EXPORT unsigned int egJoltCastRaysAtTick(EgJoltInstance instance, unsigned int tick, const EgJoltRayCast* rayCasts, unsigned int count, EgJoltRayCastResult* results);
+
 	EG_EXPORT int egJolt_Vector3_IsNearZero(EgJoltVector3 v);
 	EG_EXPORT EgJoltQuaternion egJolt_Quaternion_Normalize(EgJoltQuaternion q);
 	EG_EXPORT int egJolt_Quaternion_IsNormalized(EgJoltQuaternion q);